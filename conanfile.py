@@ -16,6 +16,7 @@ class Vroom(ConanFile):
         self.requires("imgui/[^1.91.0]")
         self.requires("eigen/[^3.4.0]")
         self.requires("miniaudio/[^0.11.0]")
+        self.requires("meshoptimizer/[>=0.20 <1]")
     
     def layout(self):
         cmake_layout(self)
@@ -15,6 +15,12 @@ uniform sampler2D metallicRoughnessTex;
 uniform int hasMetallicRoughnessTex;
 uniform sampler2D emissionTex;
 uniform int hasEmissionTex;
+uniform sampler2DArray baseColorTexArray;
+uniform int hasBaseColorTexArray;
+uniform sampler2DArray normalTexArray;
+uniform int hasNormalTexArray;
+uniform sampler2DArray metallicRoughnessTexArray;
+uniform int hasMetallicRoughnessTexArray;
 uniform float normalScale;
 
 layout(location = 0) out vec3 fragPosition_worldspace;
@@ -36,6 +42,16 @@ struct ObjMaterial {
     float metallic;
     float roughness;
     float sheen;
+
+    // Index in the texture arrays and layer in it, -1 if not packed
+    int baseColorArray;
+    int baseColorLayer;
+    int normalArray;
+    int normalLayer;
+    int metallicRoughnessArray;
+    int metallicRoughnessLayer;
+    float p3;
+    float p4;
 };
 
 layout(std140) uniform ObjMaterialsBlock {
@@ -47,17 +63,24 @@ void main()
     fragPosition_worldspace = vertexPosition_worldspace;
     ObjMaterial mat = objMaterialsBlock.objMaterials[materialId];
 
-    if (hasBaseColorTex == 1) {
+    if (hasBaseColorTexArray == 1 && mat.baseColorLayer >= 0) {
+        albedo = texture(baseColorTexArray, vec3(texcoord, mat.baseColorLayer)).rgb;
+    } else if (hasBaseColorTex == 1) {
         albedo = texture(baseColorTex, texcoord).rgb;
     } else {
         albedo = mat.baseColor;
     }
 
-    if (hasNormalTex == 1) {
+    bool hasNormalLayer = hasNormalTexArray == 1 && mat.normalLayer >= 0;
+    if (hasNormalLayer || hasNormalTex == 1) {
         // Hack to transform tangent space normal to world space!
-        vec3 normalMap = texture(normalTex, texcoord).rgb;
-        normalMap = normalize((normalMap * 2.0 - 1.0)
-            * vec3(normalScale, normalScale, 1.0));
+        // Z is rebuilt, since BC5 normal maps only store X and Y
+        vec2 normalXY = hasNormalLayer
+            ? texture(normalTexArray, vec3(texcoord, mat.normalLayer)).rg
+            : texture(normalTex, texcoord).rg;
+        normalXY = normalXY * 2.0 - 1.0;
+        vec3 normalMap = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
+        normalMap = normalize(normalMap * vec3(normalScale, normalScale, 1.0));
 
         // Transform the normal from tangent space to world space
         fragNormal_cameraspace = normalize(tbn * normalMap);
@@ -65,7 +88,12 @@ void main()
         fragNormal_cameraspace = normalize(normal_cameraspace);
     }
 
-    if (hasMetallicRoughnessTex == 1) {
+    if (hasMetallicRoughnessTexArray == 1 && mat.metallicRoughnessLayer >= 0) {
+        vec2 mrSample = texture(metallicRoughnessTexArray,
+                                vec3(texcoord, mat.metallicRoughnessLayer)).bg;
+        metallic = mrSample.r;
+        roughness = mrSample.g;
+    } else if (hasMetallicRoughnessTex == 1) {
         vec2 mrSample = texture(metallicRoughnessTex, texcoord).bg; // (Metallic in B, Roughness in G)
         metallic = mrSample.r;
         roughness = mrSample.g;
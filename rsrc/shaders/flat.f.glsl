@@ -7,6 +7,8 @@ in vec2 texcoord;
 
 uniform sampler2D baseColorTex;
 uniform int hasBaseColorTex;
+uniform sampler2DArray baseColorTexArray;
+uniform int hasBaseColorTexArray;
 
 out vec3 outColor;
 
@@ -21,6 +23,16 @@ struct ObjMaterial {
     float metallic;
     float roughness;
     float sheen;
+
+    // Index in the texture arrays and layer in it, -1 if not packed
+    int baseColorArray;
+    int baseColorLayer;
+    int normalArray;
+    int normalLayer;
+    int metallicRoughnessArray;
+    int metallicRoughnessLayer;
+    float p3;
+    float p4;
 };
 
 layout(std140) uniform ObjMaterialsBlock {
@@ -32,7 +44,9 @@ void main()
 {
     ObjMaterial mat = objMaterialsBlock.objMaterials[materialId];
 
-    if (hasBaseColorTex == 1) {
+    if (hasBaseColorTexArray == 1 && mat.baseColorLayer >= 0) {
+        outColor = texture(baseColorTexArray, vec3(texcoord, mat.baseColorLayer)).rgb;
+    } else if (hasBaseColorTex == 1) {
         outColor = texture(baseColorTex, texcoord).rgb;
     } else {
         outColor = mat.baseColor;
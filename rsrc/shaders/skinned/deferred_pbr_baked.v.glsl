@@ -0,0 +1,98 @@
+#version 330 core
+
+layout(location = 0) in vec3 vertexPosition_modelspace;
+layout(location = 1) in vec3 vertexNormal_modelspace;
+layout(location = 2) in vec2 vertexTexcoord;
+layout(location = 3) in int vertexMaterialId;
+
+// Animation
+layout(location = 4) in uvec4 boneIDs;  // Joint indices
+layout(location = 5) in vec4 weights;   // Weights
+
+// Matrices
+uniform mat4 MVP;
+uniform mat4 modelMatrix;
+uniform mat4 viewMatrix;
+uniform mat4 normalMatrix;
+
+// Skin, palettes baked in a texture (one row per frame, 3 texels per joint)
+uniform int isSkinned;
+uniform sampler2D bakedAnimationTex;
+uniform int bakedSkinColumn; // First column of this mesh's skin
+uniform ivec2 bakedClipRows; // First row, frame count
+uniform float bakedClipTime; // Seconds, already looped on the CPU
+uniform float bakedSampleRate; // Frames per second, rows are evenly spaced
+
+flat out int materialId;
+out vec3 vertexPosition_worldspace;
+out vec3 normal_cameraspace;
+out vec2 texcoord;
+out mat3 tbn; // Tangent space to world space matrix
+
+// Hacky, but simple approximation of TBN matrix calculation
+mat3 calculateTBN(vec3 normal_cameraspace)
+{
+    vec3 tangent = vec3(1.0, 0.0, 0.0); // Assume tangent aligned with x-axis
+    vec3 bitangent = normalize(cross(normal_cameraspace, tangent)); // Compute bitangent
+    
+    // Normalize to ensure orthonormality
+    if (length(bitangent) == 0.0) {
+        bitangent = vec3(0.0, 1.0, 0.0); // Use an arbitrary direction if zero
+    }
+    tangent = normalize(cross(bitangent, normal_cameraspace)); // Recompute tangent based on bitangent
+
+    // Construct the TBN matrix
+    return mat3(tangent, bitangent, normal_cameraspace);
+}
+
+mat4 fetchJoint(uint joint, int row)
+{
+    int column = bakedSkinColumn + int(joint) * 3;
+    return transpose(mat4(
+        texelFetch(bakedAnimationTex, ivec2(column, row), 0),
+        texelFetch(bakedAnimationTex, ivec2(column + 1, row), 0),
+        texelFetch(bakedAnimationTex, ivec2(column + 2, row), 0),
+        vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
+// Interpolated between the two closest baked frames
+mat4 getJointTransform(uint joint, int row, int nextRow, float alpha)
+{
+    return fetchJoint(joint, row) * (1.0 - alpha) + fetchJoint(joint, nextRow) * alpha;
+}
+
+void main()
+{
+    vec4 position;
+    vec4 normal;
+
+    if(isSkinned == 1)
+    {
+        float frame = bakedClipTime * bakedSampleRate;
+        int row = bakedClipRows.x + min(int(frame), bakedClipRows.y - 1);
+        int nextRow = bakedClipRows.x + min(int(frame) + 1, bakedClipRows.y - 1);
+        float alpha = fract(frame);
+
+        mat4 skinMatrix = 
+            weights.x * getJointTransform(boneIDs.x, row, nextRow, alpha) +
+            weights.y * getJointTransform(boneIDs.y, row, nextRow, alpha) +
+            weights.z * getJointTransform(boneIDs.z, row, nextRow, alpha) +
+            weights.w * getJointTransform(boneIDs.w, row, nextRow, alpha);
+
+        position = skinMatrix * vec4(vertexPosition_modelspace, 1);
+        normal = skinMatrix * vec4(vertexNormal_modelspace, 0);
+    }
+    else
+    {
+        position = vec4(vertexPosition_modelspace, 1);
+        normal = vec4(vertexNormal_modelspace, 0);
+    }
+
+    materialId = vertexMaterialId;
+    vertexPosition_worldspace = (modelMatrix * position).xyz;
+    normal_cameraspace = (normalMatrix * normal).xyz;
+    texcoord = vertexTexcoord;
+    tbn = calculateTBN(normal_cameraspace);
+
+    gl_Position = MVP * position;
+}
\ No newline at end of file
@@ -1,5 +1,4 @@
-#version 330 core
-#define MAX_BONES_PER_SKINNED_MESH 500
+#version 430 core
 
 layout(location = 0) in vec3 vertexPosition_modelspace;
 layout(location = 1) in vec3 vertexNormal_modelspace;
@@ -16,10 +15,11 @@ uniform mat4 modelMatrix;
 uniform mat4 viewMatrix;
 uniform mat4 normalMatrix;
 
-// Skin
+// Skin, palettes of all instances of the frame back to back
 uniform int isSkinned;
-layout(std140) uniform SkinTransformBlock {
-    mat4 boneTransforms[MAX_BONES_PER_SKINNED_MESH];
+uniform int jointOffset; // First joint of this mesh's skin
+layout(std430) readonly buffer JointPaletteBuffer {
+    mat4 jointTransforms[];
 };
 
 flat out int materialId;
@@ -52,10 +52,10 @@ void main()
     if(isSkinned == 1)
     {
         mat4 skinMatrix = 
-            weights.x * boneTransforms[boneIDs.x] +
-            weights.y * boneTransforms[boneIDs.y] +
-            weights.z * boneTransforms[boneIDs.z] +
-            weights.w * boneTransforms[boneIDs.w];
+            weights.x * jointTransforms[jointOffset + int(boneIDs.x)] +
+            weights.y * jointTransforms[jointOffset + int(boneIDs.y)] +
+            weights.z * jointTransforms[jointOffset + int(boneIDs.z)] +
+            weights.w * jointTransforms[jointOffset + int(boneIDs.w)];
 
         position = skinMatrix * vec4(vertexPosition_modelspace, 1);
         normal = skinMatrix * vec4(vertexNormal_modelspace, 0);
@@ -0,0 +1,63 @@
+#version 430 core
+// Skins the vertices of one mesh of an animated instance into that instance's own
+// vertex buffer, which is then drawn as static geometry by every pass.
+layout(local_size_x = 64) in;
+
+// ObjResource::Vertex, in 32-bit words: position (3), normal (3), texcoord (2),
+// materialId (1), joints (4), weights (4)
+#define VERTEX_STRIDE 17
+
+layout(std430) readonly buffer SourceVertexBuffer {
+    uint sourceVertices[];
+};
+layout(std430) writeonly buffer SkinnedVertexBuffer {
+    uint skinnedVertices[];
+};
+layout(std430) readonly buffer JointPaletteBuffer {
+    mat4 jointTransforms[];
+};
+
+uniform int jointOffset; // First joint of this mesh's skin
+uniform uint firstVertex;
+uniform uint vertexCount;
+
+vec3 readVec3(uint word)
+{
+    return uintBitsToFloat(uvec3(sourceVertices[word], sourceVertices[word + 1],
+                                 sourceVertices[word + 2]));
+}
+
+void writeVec3(uint word, vec3 value)
+{
+    uvec3 bits = floatBitsToUint(value);
+    skinnedVertices[word] = bits.x;
+    skinnedVertices[word + 1] = bits.y;
+    skinnedVertices[word + 2] = bits.z;
+}
+
+void main()
+{
+    if(gl_GlobalInvocationID.x >= vertexCount) return;
+    uint base = (firstVertex + gl_GlobalInvocationID.x) * VERTEX_STRIDE;
+
+    uvec4 boneIDs = uvec4(sourceVertices[base + 9], sourceVertices[base + 10],
+                          sourceVertices[base + 11], sourceVertices[base + 12]);
+    vec4 weights = uintBitsToFloat(uvec4(sourceVertices[base + 13],
+                                         sourceVertices[base + 14],
+                                         sourceVertices[base + 15],
+                                         sourceVertices[base + 16]));
+
+    mat4 skinMatrix = 
+        weights.x * jointTransforms[jointOffset + int(boneIDs.x)] +
+        weights.y * jointTransforms[jointOffset + int(boneIDs.y)] +
+        weights.z * jointTransforms[jointOffset + int(boneIDs.z)] +
+        weights.w * jointTransforms[jointOffset + int(boneIDs.w)];
+
+    writeVec3(base, (skinMatrix * vec4(readVec3(base), 1)).xyz);
+    writeVec3(base + 3, (skinMatrix * vec4(readVec3(base + 3), 0)).xyz);
+
+    // Texcoord, material and skinning data are unchanged
+    for(uint word = 6; word < VERTEX_STRIDE; ++word) {
+        skinnedVertices[base + word] = sourceVertices[base + word];
+    }
+}
@@ -0,0 +1,338 @@
+#include "Benchmarks.hpp"
+
+#include <tiny_obj_loader.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Constants.hpp"
+#include "Log.hpp"
+#include "Systems/ResourceSys/AssetPack.hpp"
+#include "Systems/ResourceSys/Obj/Animation/AnimationSampling.hpp"
+#include "Systems/ResourceSys/Obj/ObjParser.hpp"
+#include "Systems/ResourceSys/Obj/TextureCompression.hpp"
+#include "Utils/FileUtils.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double getElapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Samples 10k channels, half translations (lerp) and half rotations (nlerp), with
+// per channel binary searches (how AnimationSys used to work) and with cached
+// cursors and SIMD kernels
+void benchmarkAnimationSampling() {
+    using AnimationSampling::ChannelGroup;
+    constexpr std::size_t CHANNEL_COUNT = 10000;
+    constexpr std::size_t KEY_COUNT = 64;
+    constexpr float KEY_INTERVAL = 1.0f / 30.0f;
+    constexpr std::size_t FRAME_COUNT = 1000;
+    constexpr float FRAME_TIME = 1.0f / 60.0f;
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    std::vector<float> times(KEY_COUNT);
+    for(std::size_t i = 0; i < KEY_COUNT; ++i) {
+        times[i] = i * KEY_INTERVAL;
+    }
+    const float duration = times.back();
+
+    ChannelGroup groups[2]; // Translations, rotations
+    std::vector<glm::vec4> values(KEY_COUNT);
+    for(std::size_t c = 0; c < CHANNEL_COUNT; ++c) {
+        bool isRotation = c % 2 == 1;
+        for(auto& value : values) {
+            value = glm::vec4(distribution(random), distribution(random),
+                              distribution(random),
+                              isRotation ? distribution(random) : 0.0f);
+            if(isRotation) value = glm::normalize(value);
+        }
+        groups[isRotation].addChannel(static_cast<int>(c), times, values);
+    }
+
+    auto sampleBinarySearch = [](const ChannelGroup& group, float time, bool isRotation,
+                                 glm::vec4* out) {
+        for(std::size_t i = 0; i < group.size(); ++i) {
+            const float* keyTimes = group.times.data() + group.keyOffsets[i];
+            const glm::vec4* keyValues = group.values.data() + group.keyOffsets[i];
+            std::size_t keyCount = group.keyCounts[i];
+
+            std::size_t key = std::lower_bound(keyTimes, keyTimes + keyCount, time) - keyTimes;
+            std::size_t key1 = std::clamp<std::size_t>(key, 1, keyCount - 1);
+            std::size_t key0 = key1 - 1;
+            float alpha = std::clamp(
+                (time - keyTimes[key0]) / (keyTimes[key1] - keyTimes[key0]), 0.0f, 1.0f);
+
+            glm::vec4 from = keyValues[key0];
+            glm::vec4 to = keyValues[key1];
+            if(isRotation && glm::dot(from, to) < 0.0f) to = -to;
+
+            glm::vec4 result = from + (to - from) * alpha;
+            out[i] = isRotation ? result / std::sqrt(glm::dot(result, result)) : result;
+        }
+    };
+
+    std::vector<glm::vec4> referenceOut[2] = {std::vector<glm::vec4>(groups[0].size()),
+                                              std::vector<glm::vec4>(groups[1].size())};
+    std::vector<glm::vec4> out[2] = {std::vector<glm::vec4>(groups[0].size()),
+                                     std::vector<glm::vec4>(groups[1].size())};
+    std::vector<std::uint32_t> cursors[2] = {std::vector<std::uint32_t>(groups[0].size()),
+                                             std::vector<std::uint32_t>(groups[1].size())};
+    AnimationSampling::KeyPairs scratch;
+    auto getTime = [&](std::size_t frame) { return std::fmod(frame * FRAME_TIME, duration); };
+
+    Clock::time_point start = Clock::now();
+    for(std::size_t frame = 0; frame < FRAME_COUNT; ++frame) {
+        for(int g = 0; g < 2; ++g) {
+            sampleBinarySearch(groups[g], getTime(frame), g == 1, referenceOut[g].data());
+        }
+    }
+    double binarySearchMs = getElapsedMs(start);
+
+    start = Clock::now();
+    for(std::size_t frame = 0; frame < FRAME_COUNT; ++frame) {
+        for(int g = 0; g < 2; ++g) {
+            AnimationSampling::sample(groups[g], getTime(frame), cursors[g].data(), scratch,
+                                      out[g].data(), g == 1);
+        }
+    }
+    double cursorMs = getElapsedMs(start);
+
+    // Both methods should agree
+    float maxDifference = 0.0f;
+    for(int g = 0; g < 2; ++g) {
+        for(std::size_t i = 0; i < out[g].size(); ++i) {
+            for(int c = 0; c < 4; ++c) {
+                maxDifference =
+                    std::max(maxDifference, std::abs(out[g][i][c] - referenceOut[g][i][c]));
+            }
+        }
+    }
+
+    const double sampleCount = static_cast<double>(CHANNEL_COUNT * FRAME_COUNT);
+    Log::info() << "Animation sampling, " << CHANNEL_COUNT << " channels, " << FRAME_COUNT
+                << " frames:";
+    Log::info() << "    binary search:     " << binarySearchMs << " ms ("
+                << binarySearchMs * 1e6 / sampleCount << " ns/channel)";
+    Log::info() << "    cursors + kernels: " << cursorMs << " ms ("
+                << cursorMs * 1e6 / sampleCount << " ns/channel), "
+                << binarySearchMs / cursorMs << "x";
+    Log::info() << "    max difference:    " << maxDifference;
+}
+
+// Grid of gridSize^2 vertices with normals and texcoords, and quad faces
+std::string generateObj(std::size_t gridSize) {
+    std::string text;
+    char buffer[32];
+    auto appendFloat = [&](float value) {
+        auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                          std::chars_format::fixed, 6);
+        text += ' ';
+        text.append(buffer, end);
+    };
+
+    for(std::size_t y = 0; y < gridSize; ++y) {
+        for(std::size_t x = 0; x < gridSize; ++x) {
+            float u = static_cast<float>(x) / gridSize;
+            float v = static_cast<float>(y) / gridSize;
+            text += 'v';
+            appendFloat(u * 100.0f);
+            appendFloat(std::sin(u * 20.0f) * std::cos(v * 20.0f));
+            appendFloat(v * 100.0f);
+            text += "\nvn 0.000000 1.000000 0.000000\nvt";
+            appendFloat(u);
+            appendFloat(v);
+            text += '\n';
+        }
+    }
+    for(std::size_t y = 0; y + 1 < gridSize; ++y) {
+        for(std::size_t x = 0; x + 1 < gridSize; ++x) {
+            std::size_t corners[] = {y * gridSize + x + 1, y * gridSize + x + 2,
+                                     (y + 1) * gridSize + x + 2,
+                                     (y + 1) * gridSize + x + 1};
+            text += 'f';
+            for(std::size_t corner : corners) {
+                std::string index = std::to_string(corner);
+                text += ' ' + index + '/' + index + '/' + index;
+            }
+            text += '\n';
+        }
+    }
+    return text;
+}
+
+// Parses the biggest Wavefront resource and a generated one with tinyobjloader, and
+// with ObjParser on one thread and on all threads
+void benchmarkObjParsing() {
+    constexpr std::size_t GRID_SIZE = 512;
+    constexpr int REPEATS = 5;
+
+    struct Input {
+        std::string name;
+        std::string text;
+        std::string materials; // For tinyobjloader, ObjParser reads them from path
+        std::filesystem::path path;
+    };
+    std::vector<Input> inputs;
+
+    std::filesystem::path resourcePath =
+        std::filesystem::path(Constants::RESOURCE_DIR) / "low_poly_blendered.obj";
+    if(std::filesystem::exists(resourcePath)) {
+        std::filesystem::path materialsPath = resourcePath;
+        materialsPath.replace_extension(".mtl");
+        inputs.push_back({resourcePath.filename().string(),
+                          std::string(ResourceFile(resourcePath, nullptr).getText()),
+                          Utils::getFileContents(materialsPath), resourcePath});
+    }
+    inputs.push_back({"generated grid", generateObj(GRID_SIZE), "", "generated.obj"});
+
+    for(const Input& input : inputs) {
+        const double megabytes = input.text.size() / (1024.0 * 1024.0);
+        auto getSpeed = [&](const std::function<void()>& parse) {
+            Clock::time_point start = Clock::now();
+            for(int i = 0; i < REPEATS; ++i) parse();
+            return megabytes * REPEATS / (getElapsedMs(start) / 1000.0);
+        };
+
+        std::size_t tinyobjTriangles = 0;
+        double tinyobjSpeed = getSpeed([&] {
+            tinyobj::ObjReaderConfig config;
+            config.triangulate = true;
+            tinyobj::ObjReader reader;
+            reader.ParseFromString(input.text, input.materials, config);
+
+            tinyobjTriangles = 0;
+            for(const auto& shape : reader.GetShapes()) {
+                tinyobjTriangles += shape.mesh.indices.size() / 3;
+            }
+        });
+
+        ObjParser parser;
+        double singleThreadSpeed =
+            getSpeed([&] { parser.parse(input.text, input.path, nullptr, 1); });
+        double multiThreadSpeed =
+            getSpeed([&] { parser.parse(input.text, input.path, nullptr, 0); });
+        std::size_t triangles = 0;
+        for(const auto& shape : parser.getShapes()) triangles += shape.indices.size() / 3;
+
+        Log::info() << "OBJ parsing, " << input.name << " (" << megabytes << " MiB, "
+                    << triangles << " triangles, " << tinyobjTriangles
+                    << " with tinyobjloader):";
+        Log::info() << "    tinyobjloader:         " << tinyobjSpeed << " MiB/s";
+        Log::info() << "    ObjParser, 1 thread:   " << singleThreadSpeed << " MiB/s, "
+                    << singleThreadSpeed / tinyobjSpeed << "x";
+        Log::info() << "    ObjParser, " << parser.getChunkCount()
+                    << " chunks: " << multiThreadSpeed << " MiB/s, "
+                    << multiThreadSpeed / tinyobjSpeed << "x";
+    }
+}
+
+// Encodes the mip chain of a generated 1024x1024 RGBA image into each block
+// compressed format, and checks the finest level decodes back close to the source
+void benchmarkTextureCompression() {
+    using TextureCompression::Format;
+    constexpr int SIZE = 1024;
+    constexpr double MAX_ROUND_TRIP_RMSE = 8.0; // A few times the noise of the image
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> noise(-8, 8);
+    std::vector<unsigned char> pixels(static_cast<std::size_t>(SIZE) * SIZE * 4);
+    for(int y = 0; y < SIZE; ++y) {
+        for(int x = 0; x < SIZE; ++x) {
+            unsigned char* pixel = &pixels[(static_cast<std::size_t>(y) * SIZE + x) * 4];
+            auto noisy = [&](int value) {
+                value = std::clamp(value + noise(random), 0, 255);
+                return static_cast<unsigned char>(value);
+            };
+            pixel[0] = noisy(x / 4);
+            pixel[1] = noisy(y / 4);
+            pixel[2] = static_cast<unsigned char>(((x / 64 + y / 64) % 2) * 255);
+            pixel[3] = static_cast<unsigned char>(255 - x / 8);
+        }
+    }
+
+    std::size_t sourceSize = pixels.size() * 4 / 3; // With the mip chain
+    const std::pair<Format, const char*> formats[] = {
+        {Format::BC1, "BC1"}, {Format::BC3, "BC3"}, {Format::BC5, "BC5"}};
+    for(auto [format, name] : formats) {
+        Clock::time_point start = Clock::now();
+        TextureCompression::CompressedImage image =
+            TextureCompression::encode(pixels, SIZE, SIZE, 4, format);
+        double elapsedMs = getElapsedMs(start);
+
+        std::size_t size = 0;
+        for(const auto& level : image.levels) size += level.size();
+        Log::info() << name << " encoding: " << elapsedMs << " ms, "
+                    << SIZE * SIZE * 4.0 / 3.0 / (elapsedMs * 1000.0) << " MPixel/s, "
+                    << static_cast<double>(sourceSize) / size << "x smaller than RGBA8";
+
+        // Round trip through a decoder written from the format specs, over the
+        // channels the format keeps
+        std::vector<unsigned char> decoded =
+            TextureCompression::decodeLevel(image.levels[0], format, SIZE, SIZE);
+        const int channelCount = format == Format::BC1   ? 3
+                                 : format == Format::BC3 ? 4
+                                                         : 2;
+        double squaredError = 0.0;
+        int maxError = 0;
+        for(std::size_t i = 0; i < pixels.size(); i += 4) {
+            for(int c = 0; c < channelCount; ++c) {
+                int error = std::abs(decoded[i + c] - pixels[i + c]);
+                squaredError += error * error;
+                maxError = std::max(maxError, error);
+            }
+        }
+        double rmse = std::sqrt(squaredError / (SIZE * SIZE * channelCount));
+        Log::info() << "    round trip: " << rmse << " RMSE, " << maxError
+                    << " max error";
+        if(rmse > MAX_ROUND_TRIP_RMSE) {
+            Log::error() << name << " round trip error is over " << MAX_ROUND_TRIP_RMSE
+                         << ", the encoder is broken!";
+        }
+    }
+}
+
+const std::vector<std::pair<std::string, std::function<void()>>> BENCHMARKS = {
+    {"animation", benchmarkAnimationSampling},
+    {"bc", benchmarkTextureCompression},
+    {"obj", benchmarkObjParsing},
+};
+} // namespace
+
+namespace Benchmarks {
+// Runs the benchmark with the given name, or all of them with "all"
+bool run(const std::string& name) {
+    bool found = false;
+    for(const auto& [benchmarkName, benchmark] : BENCHMARKS) {
+        if(name == "all" || name == benchmarkName) {
+            benchmark();
+            found = true;
+        }
+    }
+
+    if(!found) {
+        Log::error() << "Unknown benchmark '" << name << "', available: " << getNames();
+    }
+    return found;
+}
+
+std::string getNames() {
+    std::string names;
+    for(const auto& [benchmarkName, benchmark] : BENCHMARKS) {
+        names += benchmarkName + ", ";
+    }
+    return names + "all";
+}
+} // namespace Benchmarks
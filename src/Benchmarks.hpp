@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+// Microbenchmarks of engine hot paths, run from the command line with -b.
+// They don't need a window or an OpenGL context.
+namespace Benchmarks {
+bool run(const std::string& name);
+std::string getNames();
+} // namespace Benchmarks
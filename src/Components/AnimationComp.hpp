@@ -1,6 +1,10 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Systems/ResourceSys/Obj/Animation/AnimationPose.hpp"
 
 enum class AnimationMode { OneShot, Loop };
 
@@ -16,6 +20,14 @@ struct AnimationComp {
     float crossfadeTime = 0.0f;
     float crossfadeDuration = 1.00f;
 
+    // Play the current animation from the container's baked joint textures, on the
+    // GPU only. Needs a baked skinning shader. Loops, without crossfade.
+    bool useBakedAnimation = false;
+    float bakedTimeOffset = 0.0f; // Seconds, to desynchronize instances
+
+    AnimationPose pose; // Per-instance pose, updated by AnimationSys
+    std::vector<std::uint32_t> keyframeCursors; // Last key sampled, per channel
+
     void setAnimation(std::size_t animNameIndex,
                       AnimationMode mode = AnimationMode::Loop) {
         if(currentAnimation != animNameIndex) {
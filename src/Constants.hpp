@@ -2,6 +2,7 @@
 
 #include <math.h>
 
+#include <cstddef>
 #include <glm/glm.hpp>
 
 #include "Utils/StringIndexor.hpp"
@@ -9,6 +10,8 @@
 namespace Constants {
 constexpr const char* GAME_NAME = "Vroom!";
 constexpr const char* RESOURCE_DIR = "rsrc";
+constexpr const char* RESOURCE_PACK_PATH = "rsrc.vpak"; // Used instead of dir if found
+constexpr const char* MESH_CACHE_DIR = "cache"; // Parsed .obj files and baked textures
 
 constexpr unsigned OPENGL_MAJOR_VERSION = 4;
 constexpr unsigned OPENGL_MINOR_VERSION = 3;
@@ -17,9 +20,28 @@ constexpr unsigned DEFAULT_WINDOW_SIZE_Y = 800;
 constexpr unsigned NO_VSYNC_MAX_FPS = 120; // Max FPS if VSync is off
 const bool ENABLE_VSYNC = true;
 const bool ENABLE_FXAA = false;
+const bool ENABLE_COMPUTE_SKINNING = true; // Skin once per frame, see skinning.c.glsl
+const bool ENABLE_MESH_CACHE = true;
 const float HORIZ_FOV = glm::radians(90.0f); // In radians
 
-constexpr unsigned MAX_BONES_PER_SKINNED_MESH = 500;
+constexpr float ANIMATION_COMPRESSION_TOLERANCE = 0.001f; // Max error per channel
+// Animation LOD, fraction of the screen height an entity must cover for its pose to
+// be updated every frame, or every 2nd frame (else every 4th, never if off screen)
+constexpr float ANIMATION_LOD_FULL_RATE_SCREEN_SIZE = 0.25f;
+constexpr float ANIMATION_LOD_HALF_RATE_SCREEN_SIZE = 0.1f;
+constexpr float BAKED_ANIMATION_SAMPLE_RATE = 30.0f; // Frames per second
+// Unused resources are evicted, least recently used first, past these budgets
+constexpr std::size_t RESOURCE_CPU_MEMORY_BUDGET = 512 * 1024 * 1024;
+constexpr std::size_t RESOURCE_GPU_MEMORY_BUDGET = 1024 * 1024 * 1024;
+constexpr double TEXTURE_UPLOAD_BUDGET_MS = 2.0; // Per frame, see TextureUploader
+// Pixel buffer ring of the TextureUploader, larger uploads are read from client memory
+constexpr std::size_t TEXTURE_UPLOAD_BUFFER_SIZE = 64 * 1024 * 1024;
+// Mip levels past the budget are dropped, see TextureStreamer. Images start with
+// their first level of at most the initial size.
+constexpr std::size_t TEXTURE_GPU_MEMORY_BUDGET = 512 * 1024 * 1024;
+constexpr unsigned TEXTURE_STREAMING_INITIAL_SIZE = 256;
+constexpr int TEXTURE_ARRAY_MAX_LAYERS = 256; // Minimum GL_MAX_ARRAY_TEXTURE_LAYERS
+constexpr std::size_t STREAMING_BUFFER_FRAME_SIZE = 4 * 1024 * 1024; // Per-frame data
 
 // Strings used as map keys, but known at compile time
 // are defined here; prefer to use a simple array with
@@ -30,8 +52,13 @@ using UniformName = Utils::StringIndexor<
     "lightIntensity", "positionTex", "normalTex", "albedoTex", "metallicTex",
     "roughnessTex", "baseColorTex", "hasBaseColorTex", "hasNormalTex",
     "metallicRoughnessTex", "hasMetallicRoughnessTex", "emissiveTex", "hasEmissiveTex",
-    "normalScale", "colorTex">;
-using UniformBlockName = Utils::StringIndexor<"ObjMaterialsBlock", "SkinTransformBlock">;
+    "normalScale", "baseColorTexArray", "hasBaseColorTexArray", "normalTexArray",
+    "hasNormalTexArray", "metallicRoughnessTexArray", "hasMetallicRoughnessTexArray",
+    "colorTex", "bakedAnimationTex", "bakedSkinColumn", "bakedClipRows",
+    "bakedClipTime", "bakedSampleRate", "jointOffset", "firstVertex", "vertexCount">;
+using UniformBlockName = Utils::StringIndexor<"ObjMaterialsBlock">;
+using StorageBlockName = Utils::StringIndexor<"JointPaletteBuffer", "SourceVertexBuffer",
+                                              "SkinnedVertexBuffer">;
 using AnimationName = Utils::StringIndexor<"Normal Walk", "Zombie Walk", "Happy">;
 
 } // namespace Constants
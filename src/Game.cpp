@@ -55,7 +55,7 @@ bool Game::init() {
     }
 
     return InputSys::get().init() && RenderingSys::get().init(mMainWindow) &&
-           AudioSys::get().init() && ResourceSys::get().loadResources();
+           AudioSys::get().init() && ResourceSys::get().scanResources();
 }
 
 void Game::requestQuit() {
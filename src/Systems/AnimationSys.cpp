@@ -1,20 +1,12 @@
 #include "AnimationSys.hpp"
 
 #include <glm/gtc/quaternion.hpp>
-#include <stack>
 
 #include "ResourceSys/Obj/Animation/Animation.hpp"
-
-namespace {
-// Interpolation helper
-glm::vec3 lerpVec3(const glm::vec3& a, const glm::vec3& b, float t) {
-    return a * (1.0f - t) + b * t;
-}
-
-glm::quat slerpQuat(const glm::quat& a, const glm::quat& b, float t) {
-    return glm::slerp(a, b, t);
-}
-} // namespace
+#include "ResourceSys/Obj/Animation/AnimationContainer.hpp"
+#include "ResourceSys/Obj/Animation/AnimationPose.hpp"
+#include "RenderingSys.hpp"
+#include "Utils/MathUtils.hpp"
 
 // Static
 AnimationSys& AnimationSys::get() {
@@ -23,71 +15,69 @@ AnimationSys& AnimationSys::get() {
 }
 
 void AnimationSys::update(float deltaTime) {
-    EntityFilter<RenderableComp, AnimationComp> filter;
-    for(auto& [renderableComp, animationComp] : filter) {
-        updateAnimation(renderableComp, animationComp, deltaTime);
+    ++mFrameIndex;
+    mHasCamera = !CameraEntity::instances.empty();
+    if(mHasCamera) {
+        const CameraEntity& camera = CameraEntity::instances[0];
+        glm::mat4 projectionMatrix = RenderingSys::get().getProjectionMatrix(camera);
+        mViewProjection = projectionMatrix * RenderingSys::get().getViewMatrix(camera);
+        mCameraPosition = camera.get<PositionComp>().coords;
+        mProjectionScale = projectionMatrix[1][1];
     }
-}
 
-// Blend factor dictates how much the current pose is blended with the new pose.
-// A blend factor of 0 means the current pose is unchanged, while a blend factor
-// of 1 means the current pose is completely replaced by the new pose.
-void AnimationSys::applyAnimationChannels(AnimationComp& animationComp,
-                                          Animation& currentAnim, float blendFactor,
-                                          float deltaTime) {
-    for(auto& channel : currentAnim.getChannels()) {
-        auto* node = channel.targetNode;
-        if(!node || channel.sampler.timestamps.size() < 2) continue;
-
-        // Find the two closest keyframes
-        auto it =
-            std::lower_bound(channel.sampler.timestamps.begin(),
-                             channel.sampler.timestamps.end(), animationComp.currentTime);
-        size_t i = std::distance(channel.sampler.timestamps.begin(), it);
-
-        size_t i0 = 0;
-        size_t i1 = 0;
-        if(i == 0) {
-            if(animationComp.mode == AnimationMode::Loop) {
-                i0 = channel.sampler.timestamps.size() - 1;
-                i1 = 0;
-            } else {
-                i0 = 0;
-                i1 = 1;
-            }
-        } else if(i >= channel.sampler.timestamps.size()) {
-            i1 = channel.sampler.timestamps.size() - 1;
-            i0 = i1 - 1;
-        } else {
-            i0 = i - 1;
-            i1 = i;
-        }
+    EntityFilter<PositionComp, RenderableComp, AnimationComp> filter;
+    std::size_t entityIndex = 0;
+    for(auto& [position, renderableComp, animationComp] : filter) {
+        // Spread entities of the same tier over frames
+        unsigned interval = getUpdateInterval(position, renderableComp);
+        bool evaluatePose = interval != 0 && (mFrameIndex + entityIndex) % interval == 0;
+        updateAnimation(renderableComp, animationComp, deltaTime, evaluatePose);
+        ++entityIndex;
+    }
+}
 
-        float t0 = channel.sampler.timestamps[i0];
-        float t1 = channel.sampler.timestamps[i1];
-        const glm::vec4& v0 = channel.sampler.values[i0];
-        const glm::vec4& v1 = channel.sampler.values[i1];
-
-        // Avoid division by zero (if two keyframes have the same time)
-        float alpha = (t1 > t0) ? (animationComp.currentTime - t0) / (t1 - t0) : 0.0f;
-
-        if(channel.targetPath == Animation::TargetPath::Translation) {
-            node->translation = lerpVec3(v0, v1, alpha) * blendFactor +
-                                node->translation * (1.0f - blendFactor);
-        } else if(channel.targetPath == Animation::TargetPath::Rotation) {
-            glm::quat q0 = glm::quat(v0.w, v0.x, v0.y, v0.z);
-            glm::quat q1 = glm::quat(v1.w, v1.x, v1.y, v1.z);
-            node->rotation =
-                slerpQuat(node->rotation, slerpQuat(q0, q1, alpha), blendFactor);
-        } else if(channel.targetPath == Animation::TargetPath::Scale) {
-            node->scale = lerpVec3(v0, v1, alpha) * blendFactor +
-                          node->scale * (1.0f - blendFactor);
-        }
+// Animation LOD: frames between pose evaluations, based on the size of the entity on
+// screen. 0 if off screen, the pose is then frozen.
+unsigned AnimationSys::getUpdateInterval(const PositionComp& position,
+                                         const RenderableComp& renderableComp) const {
+    if(!mHasCamera || !renderableComp.objectResource ||
+       !renderableComp.objectResource->boundingBox) {
+        return 1;
     }
+
+    auto [minCorner, maxCorner] =
+        renderableComp.objectResource->boundingBox->getWorldspaceAABB(
+            position.getTransform());
+    glm::vec3 center = (minCorner + maxCorner) * 0.5f;
+    float radius = glm::length(maxCorner - minCorner) * 0.5f;
+
+    if(!Utils::isSphereInFrustum(mViewProjection, center, radius)) return 0;
+
+    // Fraction of the screen height covered by the bounding sphere
+    float distance = glm::length(center - mCameraPosition);
+    if(distance <= radius) return 1;
+    float screenSize = radius * mProjectionScale / distance;
+
+    if(screenSize >= Constants::ANIMATION_LOD_FULL_RATE_SCREEN_SIZE) return 1;
+    if(screenSize >= Constants::ANIMATION_LOD_HALF_RATE_SCREEN_SIZE) return 2;
+    return 4;
 }
 
-void AnimationSys::updateAnimation(RenderableComp& renderableComp,
-                                   AnimationComp& animationComp, float deltaTime) {
+void AnimationSys::applyAnimation(AnimationComp& animationComp,
+                                  const Animation& currentAnim, float blendFactor) {
+    animationComp.pose.applyAnimation(currentAnim, animationComp.currentTime, blendFactor,
+                                      animationComp.mode == AnimationMode::Loop,
+                                      animationComp.keyframeCursors, mSampleScratch,
+                                      mSampledValues);
+}
+
+// Time always advances, evaluatePose only says if the pose should be sampled this
+// frame, so throttled instances stay in sync with the others
+void AnimationSys::updateAnimation(const RenderableComp& renderableComp,
+                                   AnimationComp& animationComp, float deltaTime,
+                                   bool evaluatePose) {
+    if(animationComp.useBakedAnimation) return; // Evaluated in the vertex shader
+
     // Detect animation change and initialize crossfade
     if(animationComp.currentAnimation != animationComp.previousAnimation) {
         animationComp.previousAnimation = animationComp.currentAnimation;
@@ -96,7 +86,12 @@ void AnimationSys::updateAnimation(RenderableComp& renderableComp,
 
     if(!renderableComp.objectResource->animationContainer) return;
 
-    auto animationContainer = renderableComp.objectResource->animationContainer;
+    const auto& animationContainer = renderableComp.objectResource->animationContainer;
+    if(animationComp.pose.container != animationContainer.get()) {
+        animationComp.pose.reset(*animationContainer); // New instance or model
+        evaluatePose = true;
+    }
+
     auto currentAnim = animationContainer->getAnimation(animationComp.currentAnimation);
     if(!currentAnim) return;
 
@@ -129,62 +124,15 @@ void AnimationSys::updateAnimation(RenderableComp& renderableComp,
     }
 
     // During crossfade, interpolate between old and new animations
+    float blendFactor = 1.0f;
     if(animationComp.crossfadeTime > 0.0f) {
-        float blendFactor =
-            1.0f - (animationComp.crossfadeTime / animationComp.crossfadeDuration);
+        blendFactor = 1.0f - (animationComp.crossfadeTime / animationComp.crossfadeDuration);
         animationComp.crossfadeTime -= deltaTime;
-        applyAnimationChannels(animationComp, *currentAnim, blendFactor, deltaTime);
-    } else {
-        applyAnimationChannels(animationComp, *currentAnim, 1.0f, deltaTime);
     }
 
-    // Update mesh and skin transforms with new node transforms
-    std::unordered_map<AnimationNode*, glm::mat4> cachedTransforms;
-    updateMeshTransforms(*renderableComp.objectResource.get(), cachedTransforms);
-    for(auto& skin : animationContainer->getSkins()) {
-        skin->updateTransformBuffer(cachedTransforms);
-    }
-}
+    if(!evaluatePose) return;
+    applyAnimation(animationComp, *currentAnim, blendFactor);
 
-// Handles skeletal (not skinned) animation
-void AnimationSys::updateMeshTransforms(
-    const ObjResource& objResource,
-    std::unordered_map<AnimationNode*, glm::mat4>& cachedTransforms) {
-    // Apply all joints transformations, from root to animationNode, for each mesh
-    for(auto& mesh : objResource.objMeshes) {
-        if(!mesh->animationNode) continue;
-        AnimationNode* joint = mesh->animationNode;
-        std::stack<AnimationNode*> stack;
-        glm::mat4 accumulatedTransform = glm::mat4(1.0f);
-
-        // Go up the hierarchy
-        // If we hit a joint that has already been processed, we can use its cached
-        // transform
-        while(joint != nullptr) {
-            if(cachedTransforms.find(joint) != cachedTransforms.end()) {
-                accumulatedTransform = cachedTransforms[joint];
-                break;
-            }
-
-            stack.push(joint);
-            joint = joint->parent;
-        }
-
-        // Apply from root (or after last cached) to joint
-        while(!stack.empty()) {
-            joint = stack.top();
-            stack.pop();
-
-            glm::mat4 localTransform =
-                glm::translate(glm::mat4(1.0f), joint->translation) *
-                glm::mat4_cast(joint->rotation) *
-                glm::scale(glm::mat4(1.0f), joint->scale);
-
-            accumulatedTransform = accumulatedTransform * localTransform;
-            cachedTransforms.insert({joint, accumulatedTransform});
-            joint = joint->parent;
-        }
-
-        mesh->transform = accumulatedTransform;
-    }
+    // Update global and skin transforms with new node transforms
+    animationComp.pose.updateTransforms();
 }
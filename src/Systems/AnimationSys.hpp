@@ -1,8 +1,15 @@
 #pragma once
 
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
 #include "Components/AnimationComp.hpp"
+#include "Components/PositionComp.hpp"
 #include "Components/RenderableComp.hpp"
 #include "Entities/EntityFilter.hpp"
+#include "ResourceSys/Obj/Animation/Animation.hpp"
+#include "ResourceSys/Obj/Animation/AnimationSampling.hpp"
 
 class AnimationSys {
 public:
@@ -11,9 +18,23 @@ public:
     void update(float deltaTime);
 
 private:
-    void applyAnimationChannels(AnimationComp& animationComp, Animation& currentAnim,
-                                float blendFactor, float deltaTime);
-    void updateAnimation(RenderableComp& renderableComp, AnimationComp& animationComp,
-                         float deltaTime);
-    void updateMeshTransforms(const ObjResource& objResource, std::unordered_map<AnimationNode*, glm::mat4>& cachedTransforms);
+    // Reused every update to avoid allocations
+    AnimationSampling::KeyPairs mSampleScratch;
+    std::vector<glm::vec4> mSampledValues;
+
+    // Camera of the current update, for animation LOD
+    std::uint64_t mFrameIndex = 0;
+    bool mHasCamera = false;
+    glm::mat4 mViewProjection{1.0f};
+    glm::vec3 mCameraPosition{};
+    float mProjectionScale = 1.0f;
+
+    unsigned getUpdateInterval(const PositionComp& position,
+                               const RenderableComp& renderableComp) const;
+
+    void applyAnimation(AnimationComp& animationComp, const Animation& currentAnim,
+                        float blendFactor);
+    void updateAnimation(const RenderableComp& renderableComp,
+                         AnimationComp& animationComp, float deltaTime,
+                         bool evaluatePose);
 };
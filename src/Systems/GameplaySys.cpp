@@ -16,12 +16,21 @@ GameplaySys& GameplaySys::get() {
 }
 
 void GameplaySys::start() {
+    // Load what the scene uses up front, in parallel. Anything else is loaded on use.
+    ResourceSys::get().preloadResources({"skelly", "low_poly_blendered", "skybox", "step",
+                                         "texasradiofish", "deferred_pbr",
+                                         "deferred_pbr_skinned", "light_pbr", "flat"});
+
     // Init stuff
     if(Constants::ENABLE_FXAA)
     {
         RenderingSys::get().setPostProcessShader(
             ResourceSys::get().getShaderResource("fxaa"));
     }
+    if(Constants::ENABLE_COMPUTE_SKINNING) {
+        RenderingSys::get().setSkinningShader(
+            ResourceSys::get().getShaderResource("skinning"));
+    }
 
     // Create camera
     CameraEntity camera;
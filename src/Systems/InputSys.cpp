@@ -1,5 +1,6 @@
 #include "InputSys.hpp"
 
+#include <array>
 #include <cmath>
 #include <glm/gtx/norm.hpp>
 #include <memory>
@@ -14,6 +15,23 @@
 #include "Systems/UISys.hpp"
 #include "Utils/MathUtils.hpp"
 
+namespace {
+struct DebugRenderMode {
+    const char* shaderName; // Light shader
+    const char* description;
+};
+
+// The first mode is normal rendering
+constexpr std::array<DebugRenderMode, 6> DEBUG_RENDER_MODES = {{
+    {"light_pbr", "disabled"},
+    {"test_lightPosition", "worldspace position"},
+    {"test_lightNormal", "cameraspace normal"},
+    {"test_lightAlbedo", "albedo"},
+    {"test_lightMetallic", "metallic"},
+    {"test_lightRoughness", "roughness"},
+}};
+} // namespace
+
 // Static
 InputSys& InputSys::get() {
     static std::unique_ptr<InputSys> instance = std::make_unique<InputSys>();
@@ -192,19 +210,16 @@ void InputSys::handleWalking(float deltaTime) {
         }
 
         if(mShowDebugWalkVectors) {
-            RenderingSys::get().addDebugShape(
-                {positionComp.coords, mWalkInputDirection * 3.0f + positionComp.coords},
-                std::vector<glm::vec3>(2, {1, 0, 0}));
+            RenderingSys::get().addDebugLine(
+                positionComp.coords, mWalkInputDirection * 3.0f + positionComp.coords,
+                {1, 0, 0});
         }
     }
 
     if(mShowDebugWalkVectors) {
-        RenderingSys::get().addDebugShape(
-            {positionComp.coords, physicsComp.velocity + positionComp.coords},
-            std::vector<glm::vec3>(2, {0, 1, 0}));
-        RenderingSys::get().addDebugShape(
-            Utils::generateCircle(2, positionComp.coords, {0, 1, 0}, 32),
-            std::vector<glm::vec3>(32, {0, 1, 0}), GL_LINE_LOOP);
+        RenderingSys::get().addDebugLine(
+            positionComp.coords, physicsComp.velocity + positionComp.coords, {0, 1, 0});
+        RenderingSys::get().addDebugCircle(2, positionComp.coords, {0, 1, 0}, {0, 1, 0});
     }
 
     if(currentSpeedSq < 0.4 || !physicsComp.currentCollision.yNeg) {
@@ -224,42 +239,24 @@ void InputSys::handleWalking(float deltaTime) {
 }
 
 void InputSys::cycleDebugRenderMode() {
-    switch(mDebugRenderMode) {
-        case 0:
-            ++mDebugRenderMode;
-            LightEntity::instances[0].get<LightComp>().shader =
-                ResourceSys::get().getShaderResource("test_lightPosition");
-            Log::debug() << "Debug render mode: worldspace position";
-            break;
-        case 1:
-            ++mDebugRenderMode;
-            LightEntity::instances[0].get<LightComp>().shader =
-                ResourceSys::get().getShaderResource("test_lightNormal");
-            Log::debug() << "Debug render mode: cameraspace normal";
-            break;
-        case 2:
-            ++mDebugRenderMode;
-            LightEntity::instances[0].get<LightComp>().shader =
-                ResourceSys::get().getShaderResource("test_lightAlbedo");
-            Log::debug() << "Debug render mode: albedo";
-            break;
-        case 3:
-            ++mDebugRenderMode;
-            LightEntity::instances[0].get<LightComp>().shader =
-                ResourceSys::get().getShaderResource("test_lightMetallic");
-            Log::debug() << "Debug render mode: metallic";
-            break;
-        case 4:
-            ++mDebugRenderMode;
-            LightEntity::instances[0].get<LightComp>().shader =
-                ResourceSys::get().getShaderResource("test_lightRoughness");
-            Log::debug() << "Debug render mode: roughness";
-            break;
-        default:
-            mDebugRenderMode = 0;
-            LightEntity::instances[0].get<LightComp>().shader =
-                ResourceSys::get().getShaderResource("light_pbr");
-            Log::debug() << "Debug render mode disabled.";
-            break;
+    // Resolved once, resources are scanned after init()
+    if(mDebugRenderShaders.empty()) {
+        for(const DebugRenderMode& mode : DEBUG_RENDER_MODES) {
+            mDebugRenderShaders.push_back(
+                ResourceSys::get().findShaderResource(mode.shaderName));
+        }
+    }
+
+    mDebugRenderMode = (mDebugRenderMode + 1) % DEBUG_RENDER_MODES.size();
+    ShaderResource::CPtr shader =
+        ResourceSys::get().getShaderResource(mDebugRenderShaders[mDebugRenderMode]);
+    if(!shader) return;
+
+    LightEntity::instances[0].get<LightComp>().shader = shader;
+    if(mDebugRenderMode == 0) {
+        Log::debug() << "Debug render mode disabled.";
+    } else {
+        Log::debug() << "Debug render mode: "
+                     << DEBUG_RENDER_MODES[mDebugRenderMode].description;
     }
 }
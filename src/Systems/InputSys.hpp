@@ -1,9 +1,13 @@
 #pragma once
 #include <SDL2/SDL.h>
 
+#include <cstddef>
 #include <glm/glm.hpp>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
+
+#include "Systems/ResourceSys/ShaderResource.hpp"
 
 class InputSys {
 public:
@@ -35,7 +39,8 @@ private:
 
     glm::vec3 mWalkInputDirection{}; // Walk input direction for current step
     bool mRunning = false;
-    int mDebugRenderMode = 0;
+    std::size_t mDebugRenderMode = 0;
+    std::vector<ShaderResource::Handle> mDebugRenderShaders; // By mode
     bool mShowDebugWalkVectors = false;
 
     void handleNeed(InputNeed need, bool isKeyDown);
@@ -5,7 +5,6 @@
 #include "Components/RenderableComp.hpp"
 #include "Entities/EntityFilter.hpp"
 #include "RenderingSys.hpp"
-#include "Utils/MathUtils.hpp"
 
 // Static
 PhysicsSys& PhysicsSys::get() {
@@ -179,77 +178,31 @@ void PhysicsSys::handleSphereEntityCollision(
 
 // Draw all collision shapes
 void PhysicsSys::drawCollisionShapes() {
-    auto drawBox = [this](const glm::vec3& minCorner, const glm::vec3& maxCorner,
-                          const glm::mat4& transform, const glm::vec3& color) {
-        std::vector<glm::vec3> vertices = {// Bottom face
-                                           minCorner,
-                                           {maxCorner.x, minCorner.y, minCorner.z},
-                                           {maxCorner.x, minCorner.y, minCorner.z},
-                                           {maxCorner.x, maxCorner.y, minCorner.z},
-                                           {maxCorner.x, maxCorner.y, minCorner.z},
-                                           {minCorner.x, maxCorner.y, minCorner.z},
-                                           {minCorner.x, maxCorner.y, minCorner.z},
-                                           minCorner,
-
-                                           // Top face
-                                           {minCorner.x, minCorner.y, maxCorner.z},
-                                           {maxCorner.x, minCorner.y, maxCorner.z},
-                                           {maxCorner.x, minCorner.y, maxCorner.z},
-                                           {maxCorner.x, maxCorner.y, maxCorner.z},
-                                           {maxCorner.x, maxCorner.y, maxCorner.z},
-                                           {minCorner.x, maxCorner.y, maxCorner.z},
-                                           {minCorner.x, maxCorner.y, maxCorner.z},
-                                           {minCorner.x, minCorner.y, maxCorner.z},
-
-                                           // Vertical edges
-                                           minCorner,
-                                           {minCorner.x, minCorner.y, maxCorner.z},
-                                           {maxCorner.x, minCorner.y, minCorner.z},
-                                           {maxCorner.x, minCorner.y, maxCorner.z},
-                                           {minCorner.x, maxCorner.y, minCorner.z},
-                                           {minCorner.x, maxCorner.y, maxCorner.z},
-                                           {maxCorner.x, maxCorner.y, minCorner.z},
-                                           {maxCorner.x, maxCorner.y, maxCorner.z}};
-
-        for(auto& vertex : vertices) {
-            vertex = glm::vec3(transform * glm::vec4(vertex, 1.0f));
-        }
-        RenderingSys::get().addDebugShape(
-            vertices, std::vector<glm::vec3>(vertices.size(), color), GL_LINES);
-    };
+    RenderingSys& rendering = RenderingSys::get();
 
     // Boxes
     EntityFilter<PositionComp, RenderableComp, BoxPhysicsComp> boxEntites;
     for(const auto& [position, renderable, physics] : boxEntites) {
         const auto& obb = renderable.objectResource->boundingBox;
 
-        drawBox(obb->minCorner, obb->maxCorner, position.getTransform(),
-                {0.53f, 0.53f, 1.0f});
-        drawBox(physics.minCorner, physics.maxCorner, glm::mat4(1.0f),
-                {1.0f, physics.currentCollision.colliding ? 1.0f : 0.0f, 0.0f});
+        rendering.addDebugBox(obb->minCorner, obb->maxCorner, position.getTransform(),
+                              {0.53f, 0.53f, 1.0f});
+        rendering.addDebugBox(
+            physics.minCorner, physics.maxCorner, glm::mat4(1.0f),
+            {1.0f, physics.currentCollision.colliding ? 1.0f : 0.0f, 0.0f});
 
         // Draw velocity vectors
-        RenderingSys::get().addDebugShape(
-            {physics.minCorner, physics.minCornerVelocity + physics.minCorner},
-            std::vector<glm::vec3>(2, {0, 1, 0.5}), GL_LINES);
-        RenderingSys::get().addDebugShape(
-            {physics.maxCorner, physics.maxCornerVelocity + physics.maxCorner},
-            std::vector<glm::vec3>(2, {0, 1, 0.5}), GL_LINES);
+        rendering.addDebugLine(physics.minCorner,
+                               physics.minCornerVelocity + physics.minCorner, {0, 1, 0.5});
+        rendering.addDebugLine(physics.maxCorner,
+                               physics.maxCornerVelocity + physics.maxCorner, {0, 1, 0.5});
     }
 
     // Spheres
     EntityFilter<PositionComp, RenderableComp, SpherePhysicsComp> sphereEntities;
     for(const auto& [position, renderable, physics] : sphereEntities) {
-        const auto& debugPoint = Utils::generateSphere(
-            physics.radius, position.coords + physics.positionOffset);
-
-        for(const auto& circle : debugPoint) {
-            RenderingSys::get().addDebugShape(
-                circle,
-                std::vector<glm::vec3>(
-                    circle.size(),
-                    {1.0f, physics.currentCollision.colliding ? 1.0f : 0.0f, 0.0f}),
-                GL_LINE_LOOP);
-        }
+        rendering.addDebugSphere(
+            physics.radius, position.coords + physics.positionOffset,
+            {1.0f, physics.currentCollision.colliding ? 1.0f : 0.0f, 0.0f});
     }
 }
@@ -2,6 +2,11 @@
 
 #include <glad/glad.h>
 
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp> // For lookAt()
 
 #include "Components/PhysicsComp.hpp"
@@ -9,9 +14,12 @@
 #include "Constants.hpp"
 #include "Entities/EntityFilter.hpp"
 #include "Log.hpp"
+#include "ResourceSys/Obj/Animation/AnimationContainer.hpp"
 #include "ResourceSys/Obj/Animation/Skin.hpp"
 #include "ResourceSys/Obj/GPUBuffer.hpp"
 #include "ResourceSys/Obj/ObjResource.hpp"
+#include "ResourceSys/Obj/TextureStreamer.hpp"
+#include "ResourceSys/Obj/TextureUploader.hpp"
 #include "ResourceSys/ResourceSys.hpp"
 #include "UISys.hpp"
 
@@ -22,6 +30,7 @@ RenderingSys& RenderingSys::get() {
 }
 
 RenderingSys::~RenderingSys() {
+    mStreamingBuffer.reset(); // Needs the context
     SDL_GL_DeleteContext(mContext);
     glDeleteTextures(GBufferTexture::COUNT, mDeferredTextures);
 }
@@ -81,12 +90,17 @@ void RenderingSys::clear() {
 }
 
 void RenderingSys::render(SDL_Window* window) {
-    std::vector<std::tuple<PositionComp*, RenderableComp*>> forwardShadedEntities;
+    std::vector<std::tuple<PositionComp*, RenderableComp*, const AnimationComp*>>
+        forwardShadedEntities;
 
     const CameraEntity& camera = CameraEntity::instances[0];
     glm::mat4 viewMatrix = getViewMatrix(camera);
     glm::mat4 projectionMatrix = getProjectionMatrix(camera);
     mCurrentTime = SDL_GetTicks();
+    mCameraPosition = camera.get<PositionComp>().coords;
+    TextureUploader::get().update();
+    uploadJointPalettes();
+    skinVertices();
 
     // First pass: render entities to GBuffer
     glDepthMask(GL_TRUE);
@@ -94,12 +108,15 @@ void RenderingSys::render(SDL_Window* window) {
     glDisable(GL_BLEND);
     glBindFramebuffer(GL_FRAMEBUFFER, mDeferredFramebuffer);
 
-    EntityFilter<PositionComp, RenderableComp> renderableFilter;
-    for(const auto& [position, renderable] : renderableFilter) {
+    EntityFilter<PositionComp, RenderableComp, std::optional<AnimationComp>>
+        renderableFilter;
+    for(const auto& [position, renderable, animation] : renderableFilter) {
+        const AnimationComp* animationComp = animation ? &animation->get() : nullptr;
         if(renderable.shadingType == RenderableComp::ShadingType::ForwardShaded) {
-            forwardShadedEntities.emplace_back(&position, &renderable);
+            forwardShadedEntities.emplace_back(&position, &renderable, animationComp);
         } else {
-            renderRenderable(viewMatrix, projectionMatrix, position, renderable);
+            renderRenderable(viewMatrix, projectionMatrix, position, renderable,
+                             animationComp);
         }
     }
 
@@ -121,8 +138,8 @@ void RenderingSys::render(SDL_Window* window) {
     glDepthMask(GL_TRUE);
     glEnable(GL_DEPTH_TEST);
     glDisable(GL_BLEND);
-    for(const auto& [position, renderable] : forwardShadedEntities) {
-        renderRenderable(viewMatrix, projectionMatrix, *position, *renderable);
+    for(const auto& [position, renderable, animation] : forwardShadedEntities) {
+        renderRenderable(viewMatrix, projectionMatrix, *position, *renderable, animation);
     }
 
     // Fourth pass: post-process rendering if shader is present
@@ -134,13 +151,7 @@ void RenderingSys::render(SDL_Window* window) {
     }
 
     // Render debug stuff if present, same setup as forward shaded
-    const auto& shader = ResourceSys::get().getShaderResource("basic");
-    for(const auto& [drawMode, shapes] : mDebugShapes) {
-        for(const auto& shape : shapes) {
-            renderDebugShape(*shader, viewMatrix, projectionMatrix, shape, drawMode);
-        }
-    }
-    mDebugShapes.clear();
+    renderDebugShapes(viewMatrix, projectionMatrix);
 
     // Check for gl error
     GLenum error = glGetError();
@@ -151,21 +162,137 @@ void RenderingSys::render(SDL_Window* window) {
     // Render UI and swap window
     UISys::get().render();
     SDL_GL_SwapWindow(window); // Waits for VSync if enabled
+    mStreamingBuffer->endFrame();
+    TextureStreamer::get().update(); // With the mip levels requested by the frame
 }
 
 void RenderingSys::setPostProcessShader(ShaderResource::CPtr shader) {
     mPostProcessShader = std::move(shader);
 }
 
+void RenderingSys::setSkinningShader(ShaderResource::CPtr shader) {
+    mSkinningShader = std::move(shader);
+}
+
 void RenderingSys::addDebugShape(const std::vector<glm::vec3>& points,
                                  const std::vector<glm::vec3>& colors, GLenum drawMode) {
-    // Resize colors if not same size
-    std::vector<glm::vec3> resizedColors(points.size(),
-                                         glm::vec3(0.0f, 1.0f, 0.0f)); // Default to green
-    std::copy(colors.begin(), colors.begin() + std::min(points.size(), colors.size()),
-              resizedColors.begin());
+    auto getColor = [&colors](std::size_t i) {
+        return i < colors.size() ? colors[i] : glm::vec3(0.0f, 1.0f, 0.0f); // Default green
+    };
 
-    mDebugShapes[drawMode].emplace_back(DebugShape{points, resizedColors});
+    auto appendSegments = [&](std::vector<DebugVertex>& vertices, bool loop) {
+        if(points.size() < 2) return;
+        for(std::size_t i = 0; i + 1 < points.size(); ++i) {
+            vertices.push_back({points[i], getColor(i)});
+            vertices.push_back({points[i + 1], getColor(i + 1)});
+        }
+        if(loop) {
+            vertices.push_back({points.back(), getColor(points.size() - 1)});
+            vertices.push_back({points.front(), getColor(0)});
+        }
+    };
+
+    auto appendTriangles = [&](std::vector<DebugVertex>& vertices, bool fan) {
+        for(std::size_t i = 2; i < points.size(); ++i) {
+            std::size_t first = fan ? 0 : i - 2;
+            vertices.push_back({points[first], getColor(first)});
+            vertices.push_back({points[i - 1], getColor(i - 1)});
+            vertices.push_back({points[i], getColor(i)});
+        }
+    };
+
+    switch(drawMode) {
+    case GL_LINE_STRIP:
+        appendSegments(mDebugVertices[GL_LINES], false);
+        break;
+    case GL_LINE_LOOP:
+        appendSegments(mDebugVertices[GL_LINES], true);
+        break;
+    case GL_TRIANGLE_STRIP:
+        appendTriangles(mDebugVertices[GL_TRIANGLES], false);
+        break;
+    case GL_TRIANGLE_FAN:
+        appendTriangles(mDebugVertices[GL_TRIANGLES], true);
+        break;
+    default: {
+        // Lists, batched as-is
+        std::vector<DebugVertex>& vertices = mDebugVertices[drawMode];
+        for(std::size_t i = 0; i < points.size(); ++i) {
+            vertices.push_back({points[i], getColor(i)});
+        }
+        break;
+    }
+    }
+}
+
+void RenderingSys::addDebugLine(const glm::vec3& start, const glm::vec3& end,
+                                const glm::vec3& color) {
+    std::vector<DebugVertex>& vertices = mDebugVertices[GL_LINES];
+    vertices.push_back({start, color});
+    vertices.push_back({end, color});
+}
+
+void RenderingSys::addDebugBox(const glm::vec3& minCorner, const glm::vec3& maxCorner,
+                               const glm::mat4& transform, const glm::vec3& color) {
+    // Pairs of corner indices, bit 0: x, bit 1: y, bit 2: z (0 = min, 1 = max)
+    static constexpr int EDGES[12][2] = {
+        {0, 1}, {1, 3}, {3, 2}, {2, 0}, // Bottom face
+        {4, 5}, {5, 7}, {7, 6}, {6, 4}, // Top face
+        {0, 4}, {1, 5}, {2, 6}, {3, 7}, // Vertical edges
+    };
+
+    glm::vec3 corners[8];
+    for(int i = 0; i < 8; ++i) {
+        glm::vec3 corner = {(i & 1) ? maxCorner.x : minCorner.x,
+                            (i & 2) ? maxCorner.y : minCorner.y,
+                            (i & 4) ? maxCorner.z : minCorner.z};
+        corners[i] = glm::vec3(transform * glm::vec4(corner, 1.0f));
+    }
+
+    std::vector<DebugVertex>& vertices = mDebugVertices[GL_LINES];
+    for(const auto& [start, end] : EDGES) {
+        vertices.push_back({corners[start], color});
+        vertices.push_back({corners[end], color});
+    }
+}
+
+void RenderingSys::addDebugCircle(float radius, const glm::vec3& center,
+                                  const glm::vec3& normal, const glm::vec3& color,
+                                  int segments) {
+    if(segments < 2) return;
+
+    glm::vec3 axis1 = glm::cross(normal, glm::vec3(1.0f, 0.0f, 0.0f));
+    if(glm::length(axis1) < 0.001f) {
+        axis1 = glm::cross(normal, glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+    axis1 = glm::normalize(axis1);
+    glm::vec3 axis2 = glm::normalize(glm::cross(normal, axis1));
+
+    std::vector<DebugVertex>& vertices = mDebugVertices[GL_LINES];
+    glm::vec3 previous = center + radius * axis1;
+    for(int i = 1; i <= segments; ++i) {
+        float angle = 2.0f * glm::pi<float>() * i / segments;
+        glm::vec3 point = center + radius * (cos(angle) * axis1 + sin(angle) * axis2);
+        vertices.push_back({previous, color});
+        vertices.push_back({point, color});
+        previous = point;
+    }
+}
+
+void RenderingSys::addDebugSphere(float radius, const glm::vec3& center,
+                                  const glm::vec3& color, int segments) {
+    // Latitude circles (XZ plane, varying Y)
+    for(int i = 1; i < segments; ++i) {
+        float theta = glm::pi<float>() * i / segments;
+        addDebugCircle(radius * sin(theta), center + glm::vec3(0, radius * cos(theta), 0),
+                       glm::vec3(0, 1, 0), color, segments);
+    }
+
+    // Longitude circles, around Y
+    for(int i = 0; i < segments; ++i) {
+        float phi = glm::pi<float>() * i / segments;
+        addDebugCircle(radius, center, glm::vec3(cos(phi), 0, sin(phi)), color, segments);
+    }
 }
 
 void RenderingSys::initGL(SDL_Window* window) {
@@ -191,6 +318,9 @@ void RenderingSys::initGL(SDL_Window* window) {
     glBlendFunc(GL_ONE, GL_ONE);
     glBlendEquation(GL_FUNC_ADD);
 
+    mStreamingBuffer =
+        std::make_unique<StreamingBuffer>(Constants::STREAMING_BUFFER_FRAME_SIZE);
+
     initDeferredRendering();
     initPostProcessRendering();
 }
@@ -290,24 +420,187 @@ void RenderingSys::initPostProcessRendering() {
     }
 }
 
+// Pose the renderable is drawn with: the instance's pose if it was computed for
+// this model, else the bind pose. nullptr if the model is not animated.
+const AnimationPose* RenderingSys::getRenderPose(const RenderableComp& renderable,
+                                                 const AnimationComp* animation) const {
+    const AnimationContainer* animationContainer =
+        renderable.objectResource ? renderable.objectResource->animationContainer.get()
+                                  : nullptr;
+    if(!animationContainer) return nullptr;
+
+    if(!animation || animation->useBakedAnimation ||
+       animation->pose.container != animationContainer) {
+        return &animationContainer->getBindPose();
+    }
+    return &animation->pose;
+}
+
+// Writes the palettes of all poses drawn this frame back to back, so skinned draws
+// only need an offset. Poses shared by many entities (bind poses) are written once.
+void RenderingSys::uploadJointPalettes() {
+    using namespace Constants;
+    mJointPaletteOffsets.clear();
+    mJointPalettes = {};
+
+    std::vector<const AnimationPose*> poses;
+    std::size_t jointCount = 0;
+    EntityFilter<PositionComp, RenderableComp, std::optional<AnimationComp>>
+        renderableFilter;
+    for(const auto& [position, renderable, animation] : renderableFilter) {
+        if(!renderable.shader ||
+           renderable.shader->getStorageBlock(StorageBlockName::get<"JointPaletteBuffer">()) ==
+               -1) {
+            continue;
+        }
+
+        const AnimationPose* pose =
+            getRenderPose(renderable, animation ? &animation->get() : nullptr);
+        if(!pose || mJointPaletteOffsets.contains(pose)) continue;
+
+        mJointPaletteOffsets.emplace(pose, static_cast<std::uint32_t>(jointCount));
+        poses.push_back(pose);
+        for(const auto& transforms : pose->skinTransforms) {
+            jointCount += transforms.size();
+        }
+    }
+
+    if(jointCount == 0) return;
+    mJointPalettes = mStreamingBuffer->allocate(jointCount * sizeof(glm::mat4),
+                                                mStreamingBuffer->getStorageAlignment());
+    if(!mJointPalettes) return;
+
+    glm::mat4* joints = static_cast<glm::mat4*>(mJointPalettes.data);
+    for(const AnimationPose* pose : poses) {
+        for(const auto& transforms : pose->skinTransforms) {
+            std::memcpy(joints, transforms.data(), transforms.size() * sizeof(glm::mat4));
+            joints += transforms.size();
+        }
+    }
+    mStreamingBuffer->flush();
+}
+
+// Compute skinning: skins the vertices of each animated instance into its own vertex
+// buffer, so every pass of the frame draws them as static geometry. Instances whose
+// pose did not change since they were last skinned are skipped.
+void RenderingSys::skinVertices() {
+    static_assert(sizeof(ObjResource::Vertex) == 17 * sizeof(std::uint32_t),
+                  "skinning.c.glsl expects 17 words per vertex");
+    constexpr GLuint WORK_GROUP_SIZE = 64;
+
+    // Buffers of poses that are not drawn this frame
+    std::erase_if(mSkinnedVertices, [this](const auto& skinned) {
+        return !mSkinningShader || !mJointPaletteOffsets.contains(skinned.first);
+    });
+    if(!mSkinningShader || !mJointPalettes) return;
+
+    using namespace Constants;
+    const ShaderResource& shader = *mSkinningShader;
+    bool dispatched = false;
+
+    EntityFilter<PositionComp, RenderableComp, AnimationComp> animatedFilter;
+    for(auto& [position, renderable, animation] : animatedFilter) {
+        if(!renderable.shader || renderable.shader->getStorageBlock(
+                                     StorageBlockName::get<"JointPaletteBuffer">()) == -1) {
+            continue;
+        }
+
+        // Only instances with their own pose, bind poses are skinned by the vertex
+        // shader
+        const AnimationPose* pose = getRenderPose(renderable, &animation);
+        auto poseOffset = mJointPaletteOffsets.find(pose);
+        if(pose != &animation.pose || poseOffset == mJointPaletteOffsets.end()) continue;
+
+        const ObjResource& resource = *renderable.objectResource;
+        auto [skinnedIt, isNew] = mSkinnedVertices.try_emplace(pose);
+        SkinnedVertices& skinned = skinnedIt->second;
+        bool isSameResource = !isNew && skinned.resourceId == resource.id;
+        if(isSameResource && skinned.poseVersion == pose->version) continue;
+
+        // Rewritten by every dispatch. Unskinned meshes stay as is.
+        if(!isSameResource) {
+            skinned.buffer.setData(resource.vertexBuffer, GL_DYNAMIC_COPY);
+            skinned.resourceId = resource.id;
+        }
+
+        if(!dispatched) {
+            glUseProgram(shader.getId());
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER,
+                              shader.getStorageBlock(
+                                  StorageBlockName::get<"JointPaletteBuffer">()),
+                              mStreamingBuffer->getId(), mJointPalettes.offset,
+                              mJointPalettes.size);
+            dispatched = true;
+        }
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+                         shader.getStorageBlock(StorageBlockName::get<"SourceVertexBuffer">()),
+                         resource.vertexBuffer.getId());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+                         shader.getStorageBlock(StorageBlockName::get<"SkinnedVertexBuffer">()),
+                         skinned.buffer.getId());
+
+        // First joint of each skin of the pose
+        std::vector<GLint> skinJointOffsets;
+        GLint jointOffset = static_cast<GLint>(poseOffset->second);
+        for(const auto& transforms : pose->skinTransforms) {
+            skinJointOffsets.push_back(jointOffset);
+            jointOffset += static_cast<GLint>(transforms.size());
+        }
+
+        for(const auto& mesh : resource.objMeshes) {
+            if(!mesh->skin || mesh->vertexCount == 0 ||
+               mesh->skin->getIndex() >= skinJointOffsets.size()) {
+                continue;
+            }
+
+            glUniform1i(shader.getUniform(UniformName::get<"jointOffset">()),
+                        skinJointOffsets[mesh->skin->getIndex()]);
+            glUniform1ui(shader.getUniform(UniformName::get<"firstVertex">()),
+                         mesh->firstVertex);
+            glUniform1ui(shader.getUniform(UniformName::get<"vertexCount">()),
+                         mesh->vertexCount);
+            glDispatchCompute((mesh->vertexCount + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE,
+                              1, 1);
+        }
+        skinned.poseVersion = pose->version;
+    }
+
+    if(dispatched) {
+        glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    }
+}
+
 void RenderingSys::renderRenderable(const glm::mat4& viewMatrix,
                                     const glm::mat4& projectionMatrix,
                                     const PositionComp& position,
-                                    const RenderableComp& renderable) {
+                                    const RenderableComp& renderable,
+                                    const AnimationComp* animation) {
     constexpr unsigned POSITION_ATTRIB = 0;
     constexpr unsigned NORMAL_ATTRIB = 1;
     constexpr unsigned TEXCOORD_ATTRIB = 2;
     constexpr unsigned MATERIAL_ATTRIB = 3;
     constexpr unsigned BONE_ID_ATTRIB = 4;
     constexpr unsigned WEIGHT_ATTRIB = 5;
+    constexpr GLuint BAKED_ANIMATION_TEXTURE_UNIT = 4; // After material textures
+    constexpr GLuint FIRST_TEXTURE_ARRAY_UNIT = 5;
+
+    if(!renderable.objectResource || !renderable.shader) {
+        return;
+    }
 
-    auto setTexture = [](std::size_t samplerUniformLocation,
-                         std::size_t hasSamplerUniformLocation, const ObjTexture* texture,
-                         GLuint textureUnit) {
-        if(texture) {
+    float screenSize = getScreenSize(position, *renderable.objectResource,
+                                     projectionMatrix);
+    auto setTexture = [screenSize](std::size_t samplerUniformLocation,
+                                   std::size_t hasSamplerUniformLocation,
+                                   const ObjTexture* texture, GLuint textureUnit) {
+        if(texture) TextureStreamer::get().request(*texture->image, screenSize);
+
+        // Textures still being uploaded are left out, the material factors stand in
+        if(texture && texture->image->textureId != 0) {
             glActiveTexture(GL_TEXTURE0 + textureUnit);
             glBindTexture(GL_TEXTURE_2D, texture->image->textureId);
-            glBindSampler(textureUnit, texture->samplerId);
+            glBindSampler(textureUnit,
+                          texture->sampler ? texture->sampler->samplerId : 0);
             glUniform1i(samplerUniformLocation, textureUnit);
             glUniform1i(hasSamplerUniformLocation, 1);
 
@@ -317,23 +610,40 @@ void RenderingSys::renderRenderable(const glm::mat4& viewMatrix,
         }
     };
 
-    if(!renderable.objectResource || !renderable.shader) {
-        return;
-    }
-
     using namespace Constants;
     const ShaderResource& shader = *renderable.shader;
     const GLsizei stride = sizeof(ObjResource::Vertex);
 
-    GLint skinTransformUnformBlock = -1;
-    GLint isSkinnedUniform = -1;
-    bool isSkinnedShader = (skinTransformUnformBlock = renderable.shader->getUniformBlock(
-                                UniformBlockName::get<"SkinTransformBlock">())) != -1 &&
-                           (isSkinnedUniform = renderable.shader->getUniform(
-                                UniformName::get<"isSkinned">())) != -1;
+    // Skinned shaders either read the palette from JointPaletteBuffer, or from
+    // baked animation textures
+    GLint jointPaletteBlock =
+        shader.getStorageBlock(StorageBlockName::get<"JointPaletteBuffer">());
+    GLint bakedAnimationTexUniform =
+        shader.getUniform(UniformName::get<"bakedAnimationTex">());
+    GLint isSkinnedUniform = shader.getUniform(UniformName::get<"isSkinned">());
+    bool isSkinnedShader = isSkinnedUniform != -1 &&
+                           (jointPaletteBlock != -1 || bakedAnimationTexUniform != -1);
+
+    const AnimationContainer* animationContainer =
+        renderable.objectResource->animationContainer.get();
+    const AnimationPose* pose = getRenderPose(renderable, animation);
+    const BakedAnimations* bakedAnimations = nullptr;
+    const BakedAnimations::Clip* bakedClip = nullptr;
+    if(animationContainer && animation && animation->useBakedAnimation &&
+       bakedAnimationTexUniform != -1) {
+        bakedAnimations = &animationContainer->getBakedAnimations();
+        bakedClip = bakedAnimations->getClip(animation->currentAnimation);
+    }
 
     glUseProgram(shader.getId());
-    glBindBuffer(GL_ARRAY_BUFFER, renderable.objectResource->vertexBuffer.getId());
+    // Vertices already skinned by the compute pass are drawn as static geometry
+    auto skinned = mSkinnedVertices.find(pose);
+    bool isPreSkinned = skinned != mSkinnedVertices.end() &&
+                        skinned->second.resourceId == renderable.objectResource->id &&
+                        skinned->second.poseVersion == pose->version;
+    glBindBuffer(GL_ARRAY_BUFFER, isPreSkinned
+                                      ? skinned->second.buffer.getId()
+                                      : renderable.objectResource->vertexBuffer.getId());
 
     // Per object uniforms
     glUniform1ui(shader.getUniform(UniformName::get<"time">()), mCurrentTime);
@@ -357,6 +667,28 @@ void RenderingSys::renderRenderable(const glm::mat4& viewMatrix,
                               (void*)offsetof(ObjResource::Vertex, weights));
     }
 
+    // The vertex shader samples the clip at (time + offset). Looped here in double
+    // precision, a float time in seconds would lose frames after a few hours.
+    if(bakedClip) {
+        double clipTime =
+            bakedClip->duration > 0.0f
+                ? std::fmod(mCurrentTime / 1000.0 + animation->bakedTimeOffset,
+                            static_cast<double>(bakedClip->duration))
+                : 0.0;
+        if(clipTime < 0.0) clipTime += bakedClip->duration;
+
+        glActiveTexture(GL_TEXTURE0 + BAKED_ANIMATION_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D, bakedAnimations->getTextureId());
+        glBindSampler(BAKED_ANIMATION_TEXTURE_UNIT, 0);
+        glUniform1i(bakedAnimationTexUniform, BAKED_ANIMATION_TEXTURE_UNIT);
+        glUniform2i(shader.getUniform(UniformName::get<"bakedClipRows">()),
+                    bakedClip->firstRow, bakedClip->frameCount);
+        glUniform1f(shader.getUniform(UniformName::get<"bakedClipTime">()),
+                    static_cast<float>(clipTime));
+        glUniform1f(shader.getUniform(UniformName::get<"bakedSampleRate">()),
+                    bakedAnimations->getSampleRate());
+    }
+
     // Enable vertex attributes
     glEnableVertexAttribArray(POSITION_ATTRIB);
     glEnableVertexAttribArray(NORMAL_ATTRIB);
@@ -379,10 +711,55 @@ void RenderingSys::renderRenderable(const glm::mat4& viewMatrix,
     glVertexAttribIPointer(MATERIAL_ATTRIB, 1, GL_UNSIGNED_INT, stride,
                            (void*)offsetof(ObjResource::Vertex, materialId));
 
+    // First joint of each skin of the pose in the frame's palettes
+    std::vector<GLint> skinJointOffsets;
+    if(jointPaletteBlock != -1 && isSkinnedShader && pose && mJointPalettes) {
+        auto poseOffset = mJointPaletteOffsets.find(pose);
+        if(poseOffset != mJointPaletteOffsets.end()) {
+            GLint jointOffset = static_cast<GLint>(poseOffset->second);
+            for(const auto& transforms : pose->skinTransforms) {
+                skinJointOffsets.push_back(jointOffset);
+                jointOffset += static_cast<GLint>(transforms.size());
+            }
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER, jointPaletteBlock,
+                              mStreamingBuffer->getId(), mJointPalettes.offset,
+                              mJointPalettes.size);
+        }
+    }
+
+    // Packed textures are only bound when the next mesh uses another array, meshes
+    // pick their layer through their material. Arrays keep their own units, as sampler
+    // types can't share one.
+    std::array<const ObjTextureArray*, ObjTextureArray::COUNT> boundArrays{};
+    std::array<bool, ObjTextureArray::COUNT> isArrayBound{};
+    auto setTextureArray = [&boundArrays, &isArrayBound](
+                               GLint samplerUniformLocation,
+                               GLint hasSamplerUniformLocation,
+                               const ObjTextureArray* array, ObjTextureArray::Slot slot) {
+        if(array && !array->isComplete()) array = nullptr;
+        if(isArrayBound[slot] && boundArrays[slot] == array) return;
+        boundArrays[slot] = array;
+        isArrayBound[slot] = true;
+
+        GLuint textureUnit = FIRST_TEXTURE_ARRAY_UNIT + slot;
+        glUniform1i(samplerUniformLocation, textureUnit);
+        if(array) {
+            glActiveTexture(GL_TEXTURE0 + textureUnit);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, array->textureId);
+            glBindSampler(textureUnit, array->sampler->samplerId);
+            glUniform1i(hasSamplerUniformLocation, 1);
+        } else {
+            glUniform1i(hasSamplerUniformLocation, 0);
+        }
+    };
+
     // Render all meshes
     for(const auto& mesh : renderable.objectResource->objMeshes) {
         // Per mesh uniforms
-        glm::mat4 modelMatrix = position.getTransform() * mesh->transform;
+        const glm::mat4& meshTransform = pose && mesh->animationNode >= 0
+                                             ? pose->globalTransforms[mesh->animationNode]
+                                             : mesh->transform;
+        glm::mat4 modelMatrix = position.getTransform() * meshTransform;
 
         glm::mat4 modelViewMatrix = viewMatrix * modelMatrix;
         glm::mat4 normalMatrix = glm::transpose(glm::inverse(modelViewMatrix));
@@ -414,14 +791,39 @@ void RenderingSys::renderRenderable(const glm::mat4& viewMatrix,
                    shader.getUniform(UniformName::get<"hasEmissiveTex">()),
                    mesh->emissiveTexture.get(), textureUnit++);
 
+        const auto& textureArrays = mesh->textureArrays;
+        setTextureArray(shader.getUniform(UniformName::get<"baseColorTexArray">()),
+                        shader.getUniform(UniformName::get<"hasBaseColorTexArray">()),
+                        textureArrays[ObjTextureArray::BaseColor].get(),
+                        ObjTextureArray::BaseColor);
+        setTextureArray(shader.getUniform(UniformName::get<"normalTexArray">()),
+                        shader.getUniform(UniformName::get<"hasNormalTexArray">()),
+                        textureArrays[ObjTextureArray::Normal].get(),
+                        ObjTextureArray::Normal);
+        setTextureArray(
+            shader.getUniform(UniformName::get<"metallicRoughnessTexArray">()),
+            shader.getUniform(UniformName::get<"hasMetallicRoughnessTexArray">()),
+            textureArrays[ObjTextureArray::MetallicRoughness].get(),
+            ObjTextureArray::MetallicRoughness);
+
         glUniform1f(shader.getUniform(UniformName::get<"normalScale">()),
                     mesh->normalScale);
 
-        if(isSkinnedShader) {
-            if(mesh->skin) {
+        if(isPreSkinned && isSkinnedShader) {
+            glUniform1i(isSkinnedUniform, 0);
+        } else if(bakedAnimationTexUniform != -1 && isSkinnedShader) {
+            if(bakedClip && mesh->skin) {
+                glUniform1i(isSkinnedUniform, 1);
+                glUniform1i(shader.getUniform(UniformName::get<"bakedSkinColumn">()),
+                            bakedAnimations->getSkinColumn(mesh->skin->getIndex()));
+            } else {
+                glUniform1i(isSkinnedUniform, 0);
+            }
+        } else if(isSkinnedShader) {
+            if(mesh->skin && mesh->skin->getIndex() < skinJointOffsets.size()) {
                 glUniform1i(isSkinnedUniform, 1);
-                glBindBufferBase(GL_UNIFORM_BUFFER, skinTransformUnformBlock,
-                                 mesh->skin->getTransformBuffer().getId());
+                glUniform1i(shader.getUniform(UniformName::get<"jointOffset">()),
+                            skinJointOffsets[mesh->skin->getIndex()]);
             } else {
                 glUniform1i(isSkinnedUniform, 0);
             }
@@ -557,48 +959,88 @@ void RenderingSys::renderPostProcessing() {
     glDisableVertexAttribArray(1);
 }
 
-void RenderingSys::renderDebugShape(const ShaderResource& shader,
-                                    const glm::mat4& viewMatrix,
-                                    const glm::mat4& projectionMatrix,
-                                    const DebugShape& shape, GLenum drawMode) {
-    if(shape.points.empty()) {
+void RenderingSys::renderDebugShapes(const glm::mat4& viewMatrix,
+                                     const glm::mat4& projectionMatrix) {
+    const GLsizei stride = sizeof(DebugVertex);
+    bool hasVertices = false;
+    for(const auto& [drawMode, vertices] : mDebugVertices) {
+        hasVertices = hasVertices || !vertices.empty();
+    }
+    if(!hasVertices) {
         return;
     }
 
     using namespace Constants;
-    glUseProgram(shader.getId());
+    // Resolved once, resources are scanned after init()
+    if(!mDebugShader) mDebugShader = ResourceSys::get().findShaderResource("basic");
+    ShaderResource::CPtr shader = ResourceSys::get().getShaderResource(mDebugShader);
+    if(!shader) {
+        for(auto& [drawMode, vertices] : mDebugVertices) vertices.clear();
+        return;
+    }
+    glUseProgram(shader->getId());
 
     // Set uniforms
     glm::mat4 MVP = projectionMatrix * viewMatrix; // No model matrix
 
-    glUniformMatrix4fv(shader.getUniform(UniformName::get<"MVP">()), 1, GL_FALSE,
+    glUniformMatrix4fv(shader->getUniform(UniformName::get<"MVP">()), 1, GL_FALSE,
                        &MVP[0][0]);
 
-    // Attributes, create buffers on the spot
-    GPUBuffer posBuf(GL_ARRAY_BUFFER, shape.points, GL_STATIC_DRAW);
-    GPUBuffer colorBuf(GL_ARRAY_BUFFER, shape.colors, GL_STATIC_DRAW);
-
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, mStreamingBuffer->getId());
 
-    // Positions (vec3)
-    glBindBuffer(GL_ARRAY_BUFFER, posBuf.getId());
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    // One draw per mode
+    for(auto& [drawMode, vertices] : mDebugVertices) {
+        if(vertices.empty()) {
+            continue;
+        }
 
-    // Colors (vec3)
-    glBindBuffer(GL_ARRAY_BUFFER, colorBuf.getId());
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        StreamingBuffer::Allocation allocation =
+            mStreamingBuffer->upload(vertices, stride);
+        vertices.clear(); // Keep capacity for next frame
+        if(!allocation) {
+            continue;
+        }
+        mStreamingBuffer->flush();
 
-    // Draw
-    glDrawArrays(drawMode,           // Mode
-                 0,                  // Start
-                 shape.points.size() // Count
-    );
+        // Positions (vec3)
+        glVertexAttribPointer(
+            0, 3, GL_FLOAT, GL_FALSE, stride,
+            (void*)(allocation.offset + offsetof(DebugVertex, position)));
+
+        // Colors (vec3)
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride,
+                              (void*)(allocation.offset + offsetof(DebugVertex, color)));
+
+        // Draw
+        glDrawArrays(drawMode,                           // Mode
+                     0,                                  // Start
+                     allocation.size / sizeof(DebugVertex) // Count
+        );
+    }
 
     glDisableVertexAttribArray(0);
     glDisableVertexAttribArray(1);
 }
 
+// Height in pixels covered by the bounding sphere of the renderable, to pick the
+// mip levels of its textures. Infinite if the camera is inside it.
+float RenderingSys::getScreenSize(const PositionComp& position,
+                                  const ObjResource& resource,
+                                  const glm::mat4& projectionMatrix) const {
+    if(!resource.boundingBox) return std::numeric_limits<float>::infinity();
+
+    auto [minCorner, maxCorner] =
+        resource.boundingBox->getWorldspaceAABB(position.getTransform());
+    glm::vec3 center = (minCorner + maxCorner) * 0.5f;
+    float radius = glm::length(maxCorner - minCorner) * 0.5f;
+    float distance = glm::length(center - mCameraPosition);
+    if(distance <= radius) return std::numeric_limits<float>::infinity();
+
+    return radius * projectionMatrix[1][1] / distance * mScreenSize.y;
+}
+
 void RenderingSys::cloneDepthBuffer(GLuint source, GLuint dest) {
     glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dest);
@@ -2,13 +2,20 @@
 #include <SDL2/SDL.h>
 #include <glad/glad.h>
 
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <memory>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
+#include "Components/AnimationComp.hpp"
 #include "Components/LightComp.hpp"
 #include "Components/PositionComp.hpp"
 #include "Components/RenderableComp.hpp"
 #include "Entities/CameraEntity.hpp"
+#include "ResourceSys/Obj/GPUBuffer.hpp"
+#include "ResourceSys/Obj/StreamingBuffer.hpp"
 
 class ShaderResource;
 class RenderingSys {
@@ -21,15 +28,27 @@ public:
     void clear();
     void render(SDL_Window* window);
     void setPostProcessShader(ShaderResource::CPtr shader);
+    void setSkinningShader(ShaderResource::CPtr shader);
 
     void addDebugShape(const std::vector<glm::vec3>& points,
                        const std::vector<glm::vec3>& colors,
                        GLenum drawMode = GL_LINE_STRIP);
+    void addDebugLine(const glm::vec3& start, const glm::vec3& end,
+                      const glm::vec3& color);
+    void addDebugBox(const glm::vec3& minCorner, const glm::vec3& maxCorner,
+                     const glm::mat4& transform, const glm::vec3& color);
+    void addDebugCircle(float radius, const glm::vec3& center, const glm::vec3& normal,
+                        const glm::vec3& color, int segments = 32);
+    void addDebugSphere(float radius, const glm::vec3& center, const glm::vec3& color,
+                        int segments = 16);
+
+    glm::mat4 getViewMatrix(const CameraEntity& camera);
+    glm::mat4 getProjectionMatrix(const CameraEntity& camera);
 
 private:
-    struct DebugShape {
-        std::vector<glm::vec3> points;
-        std::vector<glm::vec3> colors;
+    struct DebugVertex {
+        glm::vec3 position;
+        glm::vec3 color;
     };
 
     enum GBufferTexture { Position = 0, Normal, Albedo, Metallic, Roughness, COUNT };
@@ -37,9 +56,11 @@ private:
     SDL_GLContext mContext;
     unsigned mCurrentTime = 0;
     glm::ivec2 mScreenSize = {0, 0};
+    glm::vec3 mCameraPosition{0.0f}; // Of the frame
 
-    std::unordered_map<GLenum, std::vector<DebugShape>>
-        mDebugShapes; // Mapped by draw mode
+    // Debug vertices of the frame, mapped by draw mode. Strips, loops and fans are
+    // split so each mode is drawn in one call.
+    std::unordered_map<GLenum, std::vector<DebugVertex>> mDebugVertices;
 
     GLuint mDeferredFramebuffer = 0;
     GLuint mDeferredTextures[GBufferTexture::COUNT]{};
@@ -48,6 +69,23 @@ private:
     GLuint mPostProcessTexture = 0;
     GLuint mPostProcessDepthBuffer = 0;
     ShaderResource::CPtr mPostProcessShader;
+    ShaderResource::CPtr mSkinningShader; // Optional compute skinning
+    ShaderResource::Handle mDebugShader;
+    std::unique_ptr<StreamingBuffer> mStreamingBuffer; // Per-frame dynamic data
+
+    // Joint palettes of all skinned instances of the frame, in one storage buffer
+    // range. Offsets are in joints, per pose.
+    StreamingBuffer::Allocation mJointPalettes;
+    std::unordered_map<const AnimationPose*, std::uint32_t> mJointPaletteOffsets;
+
+    // Vertices of animated instances skinned by the compute pass, per pose. Dropped
+    // once their pose isn't drawn anymore.
+    struct SkinnedVertices {
+        GPUBuffer buffer;              // Same layout as the model's vertices
+        std::size_t resourceId = 0;    // Model the buffer was made for
+        std::uint64_t poseVersion = 0; // Pose version it was skinned with
+    };
+    std::unordered_map<const AnimationPose*, SkinnedVertices> mSkinnedVertices;
 
     RenderingSys(const RenderingSys&) = delete;
     RenderingSys& operator=(const RenderingSys&) = delete;
@@ -57,17 +95,21 @@ private:
     void initGL(SDL_Window* window);
     void initDeferredRendering();
     void initPostProcessRendering();
+    const AnimationPose* getRenderPose(const RenderableComp& renderable,
+                                       const AnimationComp* animation) const;
+    void uploadJointPalettes();
+    void skinVertices();
     void renderRenderable(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
-                          const PositionComp& position, const RenderableComp& renderable);
+                          const PositionComp& position, const RenderableComp& renderable,
+                          const AnimationComp* animation);
     void renderLight(const glm::mat4& viewMatrix, const PositionComp& position,
                      const LightComp& light);
     void renderPostProcessing();
-    void renderDebugShape(const ShaderResource& shader, const glm::mat4& viewMatrix,
-                          const glm::mat4& projectionMatrix, const DebugShape& shape,
-                          GLenum drawMode);
+    void renderDebugShapes(const glm::mat4& viewMatrix,
+                           const glm::mat4& projectionMatrix);
     void drawBoundingBoxes();
+    float getScreenSize(const PositionComp& position, const ObjResource& resource,
+                        const glm::mat4& projectionMatrix) const;
     void cloneDepthBuffer(GLuint source, GLuint dest);
     glm::mat4 getModelMatrix(const PositionComp& position);
-    glm::mat4 getViewMatrix(const CameraEntity& camera);
-    glm::mat4 getProjectionMatrix(const CameraEntity& camera);
 };
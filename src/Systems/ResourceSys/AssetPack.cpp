@@ -0,0 +1,221 @@
+#include "AssetPack.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "Log.hpp"
+#include "Utils/HashUtils.hpp"
+
+namespace {
+constexpr char MAGIC[4] = {'V', 'P', 'A', 'K'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint64_t FILE_ALIGNMENT = 16;
+
+// Followed by the index, paths and file contents
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint32_t pathsSize;
+};
+
+std::uint64_t alignUp(std::uint64_t value) {
+    return (value + FILE_ALIGNMENT - 1) / FILE_ALIGNMENT * FILE_ALIGNMENT;
+}
+} // namespace
+
+// Static
+bool AssetPack::build(const std::filesystem::path& sourceDir,
+                      const std::filesystem::path& packPath) {
+    namespace fs = std::filesystem;
+
+    struct File {
+        std::string path;
+        std::vector<char> contents;
+        IndexEntry entry;
+    };
+
+    std::error_code error;
+    std::vector<File> files;
+    for(const auto& dirEntry : fs::recursive_directory_iterator(sourceDir, error)) {
+        if(!dirEntry.is_regular_file()) continue;
+
+        File file;
+        file.path = dirEntry.path().generic_string();
+        std::ifstream stream(dirEntry.path(), std::ios::binary);
+        file.contents.assign(std::istreambuf_iterator<char>(stream),
+                             std::istreambuf_iterator<char>());
+        if(!stream.good() && !stream.eof()) {
+            Log::error() << "Failed to read '" << file.path << "' for packing.";
+            return false;
+        }
+        files.push_back(std::move(file));
+    }
+    if(error) {
+        Log::error() << "Cannot pack '" << sourceDir.string() << "': " << error.message();
+        return false;
+    }
+
+    // Index sorted by path hash, for binary search
+    for(File& file : files) {
+        file.entry.pathHash = Utils::hashString(file.path);
+    }
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) {
+        return a.entry.pathHash != b.entry.pathHash ? a.entry.pathHash < b.entry.pathHash
+                                                    : a.path < b.path;
+    });
+
+    // Layout
+    std::string paths;
+    for(File& file : files) {
+        file.entry.pathOffset = static_cast<std::uint32_t>(paths.size());
+        file.entry.pathLength = static_cast<std::uint32_t>(file.path.size());
+        paths += file.path;
+    }
+
+    std::uint64_t offset =
+        alignUp(sizeof(Header) + files.size() * sizeof(IndexEntry) + paths.size());
+    for(File& file : files) {
+        file.entry.offset = offset;
+        file.entry.size = file.contents.size();
+        offset = alignUp(offset + file.contents.size());
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.entryCount = static_cast<std::uint32_t>(files.size());
+    header.pathsSize = static_cast<std::uint32_t>(paths.size());
+
+    std::ofstream stream(packPath, std::ios::binary | std::ios::trunc);
+    if(!stream.is_open()) {
+        Log::error() << "Cannot write asset pack '" << packPath.string() << "'.";
+        return false;
+    }
+
+    auto pad = [&stream]() {
+        static const char zeros[FILE_ALIGNMENT] = {};
+        std::uint64_t position = static_cast<std::uint64_t>(stream.tellp());
+        stream.write(zeros, static_cast<std::streamsize>(alignUp(position) - position));
+    };
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for(const File& file : files) {
+        stream.write(reinterpret_cast<const char*>(&file.entry), sizeof(IndexEntry));
+    }
+    stream.write(paths.data(), static_cast<std::streamsize>(paths.size()));
+    pad();
+    for(const File& file : files) {
+        stream.write(file.contents.data(),
+                     static_cast<std::streamsize>(file.contents.size()));
+        pad();
+    }
+
+    if(!stream) {
+        Log::error() << "Failed to write asset pack '" << packPath.string() << "'.";
+        return false;
+    }
+    Log::info() << "Packed " << files.size() << " files from '" << sourceDir.string()
+                << "' into '" << packPath.string() << "' ("
+                << static_cast<std::uint64_t>(stream.tellp()) / 1024 << " KiB).";
+    return true;
+}
+
+AssetPack::AssetPack(const std::filesystem::path& packPath) : mFile(packPath) {
+    if(!mFile.isOpen()) return;
+
+    Header header;
+    if(mFile.getSize() < sizeof(Header)) {
+        Log::error() << "Asset pack '" << packPath.string() << "' is truncated.";
+        return;
+    }
+    std::memcpy(&header, mFile.getData(), sizeof(Header));
+    if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+       header.version != VERSION) {
+        Log::error() << "'" << packPath.string() << "' is not a version " << VERSION
+                     << " asset pack.";
+        return;
+    }
+
+    std::uint64_t pathsOffset = sizeof(Header) + std::uint64_t(header.entryCount) *
+                                                     sizeof(IndexEntry);
+    if(pathsOffset + header.pathsSize > mFile.getSize()) {
+        Log::error() << "Asset pack '" << packPath.string() << "' is truncated.";
+        return;
+    }
+
+    // The header size keeps the index aligned in the (page aligned) mapping
+    const IndexEntry* index =
+        reinterpret_cast<const IndexEntry*>(mFile.getData() + sizeof(Header));
+    for(std::uint32_t i = 0; i < header.entryCount; ++i) {
+        if(index[i].offset + index[i].size > mFile.getSize() ||
+           index[i].pathOffset + std::uint64_t(index[i].pathLength) > header.pathsSize) {
+            Log::error() << "Asset pack '" << packPath.string() << "' is corrupt.";
+            return;
+        }
+    }
+
+    mIndex = index;
+    mEntryCount = header.entryCount;
+    mPaths = reinterpret_cast<const char*>(mFile.getData() + pathsOffset);
+    Log::debug() << "Opened asset pack '" << packPath.string() << "' with " << mEntryCount
+                 << " files.";
+}
+
+std::span<const unsigned char> AssetPack::getFile(
+    const std::filesystem::path& path) const {
+    const IndexEntry* entry = find(path);
+    if(!entry) return {};
+    return {mFile.getData() + entry->offset, static_cast<std::size_t>(entry->size)};
+}
+
+bool AssetPack::contains(const std::filesystem::path& path) const {
+    return find(path) != nullptr;
+}
+
+std::vector<std::filesystem::path> AssetPack::getPaths() const {
+    std::vector<std::filesystem::path> paths;
+    paths.reserve(mEntryCount);
+    for(std::uint32_t i = 0; i < mEntryCount; ++i) {
+        paths.emplace_back(getPath(mIndex[i]));
+    }
+    return paths;
+}
+
+const AssetPack::IndexEntry* AssetPack::find(const std::filesystem::path& path) const {
+    if(!mIndex) return nullptr;
+
+    std::string key = path.generic_string();
+    std::uint64_t hash = Utils::hashString(key);
+    const IndexEntry* end = mIndex + mEntryCount;
+    const IndexEntry* entry = std::lower_bound(
+        mIndex, end, hash,
+        [](const IndexEntry& e, std::uint64_t value) { return e.pathHash < value; });
+
+    // Collisions are next to each other
+    for(; entry != end && entry->pathHash == hash; ++entry) {
+        if(getPath(*entry) == key) return entry;
+    }
+    return nullptr;
+}
+
+std::string_view AssetPack::getPath(const IndexEntry& entry) const {
+    return {mPaths + entry.pathOffset, entry.pathLength};
+}
+
+ResourceFile::ResourceFile(const std::filesystem::path& path, const AssetPack* pack) {
+    if(pack) {
+        mData = pack->getFile(path);
+        if(!isOpen()) {
+            Log::error() << "Cannot find '" << path.string() << "' in asset pack.";
+        }
+        return;
+    }
+
+    mMappedFile = std::make_unique<Utils::MappedFile>(path);
+    if(mMappedFile->isOpen()) {
+        mData = {mMappedFile->getData(), mMappedFile->getSize()};
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Utils/MappedFile.hpp"
+
+// Single file holding many resource files, read straight from a memory mapping.
+// Files are found through an index sorted by the hash of their path, and their
+// contents are aligned for direct use.
+class AssetPack {
+public:
+    using Ptr = std::shared_ptr<AssetPack>;
+    using CPtr = std::shared_ptr<const AssetPack>;
+
+    static Ptr create(const std::filesystem::path& packPath) {
+        return std::make_shared<AssetPack>(packPath);
+    }
+
+    // Packing tool, packs every file under sourceDir. Files keep their path as
+    // found (e.g. rsrc/shaders/basic.v.glsl).
+    static bool build(const std::filesystem::path& sourceDir,
+                      const std::filesystem::path& packPath);
+
+    AssetPack(const std::filesystem::path& packPath);
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    bool isOpen() const { return mIndex != nullptr; }
+    // Empty if the file is not in the pack
+    std::span<const unsigned char> getFile(const std::filesystem::path& path) const;
+    bool contains(const std::filesystem::path& path) const;
+    std::vector<std::filesystem::path> getPaths() const;
+
+private:
+    struct IndexEntry {
+        std::uint64_t pathHash;
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint32_t pathOffset;
+        std::uint32_t pathLength;
+    };
+
+    Utils::MappedFile mFile;
+    const IndexEntry* mIndex = nullptr; // Points into the mapping
+    std::uint32_t mEntryCount = 0;
+    const char* mPaths = nullptr;
+
+    const IndexEntry* find(const std::filesystem::path& path) const;
+    std::string_view getPath(const IndexEntry& entry) const;
+};
+
+// Bytes of a resource file, from the pack if there is one, else mapped from disk
+class ResourceFile {
+public:
+    ResourceFile(const std::filesystem::path& path, const AssetPack* pack);
+
+    bool isOpen() const { return mData.data() != nullptr; }
+    std::span<const unsigned char> getData() const { return mData; }
+    std::string_view getText() const {
+        return {reinterpret_cast<const char*>(mData.data()), mData.size()};
+    }
+
+private:
+    std::unique_ptr<Utils::MappedFile> mMappedFile; // If not from a pack
+    std::span<const unsigned char> mData;
+};
@@ -2,12 +2,26 @@
 
 #include "Systems/AudioSys.hpp"
 
-AudioResource::AudioResource(const std::filesystem::path& path)
+AudioResource::AudioResource(const std::filesystem::path& path, AssetPack::CPtr pack)
     : mEngine(AudioSys::get().getEngine()),
-    mMiniAudioSound(std::make_unique<ma_sound>()) {
-    ma_result result =
-        ma_sound_init_from_file(&mEngine->miniAudioEngine, path.string().c_str(), 0,
-                                NULL, NULL, mMiniAudioSound.get());
+    mMiniAudioSound(std::make_unique<ma_sound>()),
+    mPack(std::move(pack)) {
+    ma_result result;
+    if(mPack) {
+        std::span<const unsigned char> data = mPack->getFile(path);
+        mDecoder = std::make_unique<ma_decoder>();
+        result = ma_decoder_init_memory(data.data(), data.size(), NULL, mDecoder.get());
+        if(result == MA_SUCCESS) {
+            result = ma_sound_init_from_data_source(&mEngine->miniAudioEngine,
+                                                    mDecoder.get(), 0, NULL,
+                                                    mMiniAudioSound.get());
+        } else {
+            mDecoder = nullptr;
+        }
+    } else {
+        result = ma_sound_init_from_file(&mEngine->miniAudioEngine, path.string().c_str(),
+                                         0, NULL, NULL, mMiniAudioSound.get());
+    }
     if(result != MA_SUCCESS) {
         Log::error() << "Failed to load sound from file: "
                      << ma_result_description(result);
@@ -17,6 +31,7 @@ AudioResource::AudioResource(const std::filesystem::path& path)
 AudioResource::~AudioResource() {
     call<ma_sound_stop>();
     call<ma_sound_uninit>();
+    if(mDecoder) ma_decoder_uninit(mDecoder.get()); // After its sound
 }
 
 AudioResource::AudioResource(AudioResource&& other) noexcept { swap(*this, other); }
@@ -28,4 +43,6 @@ AudioResource& AudioResource::operator=(AudioResource&& other) noexcept {
 
 void swap(AudioResource& first, AudioResource& second) noexcept {
     std::swap(first.mMiniAudioSound, second.mMiniAudioSound);
+    std::swap(first.mPack, second.mPack);
+    std::swap(first.mDecoder, second.mDecoder);
 }
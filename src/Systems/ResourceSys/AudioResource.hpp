@@ -5,7 +5,9 @@
 #include <string>
 #include <type_traits>
 
+#include "AssetPack.hpp"
 #include "Log.hpp"
+#include "ResourceHandle.hpp"
 #include "miniaudio.h"
 #include "Systems/AudioSys.hpp"
 
@@ -13,12 +15,14 @@ class AudioResource {
 public:
     using Ptr = std::shared_ptr<AudioResource>;
     using CPtr = std::shared_ptr<const AudioResource>;
+    using Handle = ResourceHandle<AudioResource>;
 
-    static Ptr create(const std::filesystem::path& path) {
-        return std::make_shared<AudioResource>(path);
+    // Decoded from the pack's memory if given
+    static Ptr create(const std::filesystem::path& path, AssetPack::CPtr pack = nullptr) {
+        return std::make_shared<AudioResource>(path, std::move(pack));
     }
 
-    AudioResource(const std::filesystem::path& path);
+    AudioResource(const std::filesystem::path& path, AssetPack::CPtr pack = nullptr);
     ~AudioResource();
     AudioResource(const AudioResource& other) = delete; // Don't copy
     AudioResource(AudioResource&& other) noexcept;
@@ -35,6 +39,9 @@ private:
     // Its inclusion here is to ensure the proper dependency tree.
     AudioSys::Engine::Ptr mEngine;
     std::unique_ptr<ma_sound> mMiniAudioSound;
+    // Sounds from a pack are decoded from its memory, which is kept alive
+    AssetPack::CPtr mPack;
+    std::unique_ptr<ma_decoder> mDecoder;
 
 public:
     template <
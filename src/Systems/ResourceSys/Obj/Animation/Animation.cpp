@@ -10,22 +10,38 @@ Animation::Animation(AnimationContainer &container, const tinygltf::Model &model
     loadAnimationData(container, model, animation);
 }
 
+std::size_t Animation::getMemoryUsage() const {
+    std::size_t usage = 0;
+    for(std::size_t i = 0; i < mChannels.size(); ++i) {
+        usage += mChannels[i].getMemoryUsage() + mCompressedChannels[i].getMemoryUsage();
+    }
+    return usage;
+}
+
 void Animation::loadAnimationData(AnimationContainer &container,
                                   const tinygltf::Model &model,
                                   const tinygltf::Animation &animation) {
     Log::debug() << "Loading animation data for '" << animation.name << "'.";
     mName = animation.name;
+    mDuration = 0.0f;
+    mCompressedChannels[static_cast<std::size_t>(TargetPath::Rotation)].isRotation = true;
+
+    std::size_t channelCount = 0;
+    std::size_t uncompressedUsage = 0;
 
     for(size_t i = 0; i < animation.channels.size(); i++) {
         const tinygltf::AnimationChannel &channel = animation.channels[i];
         const tinygltf::AnimationSampler &sampler = animation.samplers[channel.sampler];
 
-        AnimationChannel animChannel;
-        animChannel.targetNode = container.getNode(channel.target_node);
-        animChannel.targetPath =
+        int targetNode = container.getNodeIndex(channel.target_node);
+        TargetPath targetPath =
             channel.target_path == "translation" ? TargetPath::Translation
             : channel.target_path == "rotation"  ? TargetPath::Rotation
                                                  : TargetPath::Scale;
+        if(targetNode < 0) continue;
+
+        std::vector<float> timestamps;
+        std::vector<glm::vec4> values; // Quaternion for rotation, vec3 for position/scale
 
         // Load timestamps
         const tinygltf::Accessor &input = model.accessors[sampler.input];
@@ -35,7 +51,7 @@ void Animation::loadAnimationData(AnimationContainer &container,
             &inputBuffer.data[inputView.byteOffset + input.byteOffset]);
 
         for(size_t j = 0; j < input.count; j++) {
-            animChannel.sampler.timestamps.push_back(timeData[j]);
+            timestamps.push_back(timeData[j]);
         }
 
         // Load values (translation, rotation, scale)
@@ -56,21 +72,36 @@ void Animation::loadAnimationData(AnimationContainer &container,
                 reinterpret_cast<const float *>(dataPtr + j * stride);
 
             if(channel.target_path == "rotation") {
-                animChannel.sampler.values.push_back(
+                values.push_back(
                     glm::vec4(valueData[0], valueData[1], valueData[2], valueData[3]));
             } else {
-                animChannel.sampler.values.push_back(
-                    glm::vec4(valueData[0], valueData[1], valueData[2], 0.0f));
+                values.push_back(glm::vec4(valueData[0], valueData[1], valueData[2], 0.0f));
             }
         }
 
-        mChannels.push_back(animChannel);
-    }
+        if(!timestamps.empty() && timestamps.back() > mDuration) {
+            mDuration = timestamps.back();
+        }
 
-    // Calculate duration
-    mDuration = 0.0f;
-    for(const auto &channel : mChannels) {
-        float time = channel.sampler.timestamps.back();
-        if(time > mDuration) mDuration = time;
+        ChannelGroup uncompressed;
+        uncompressed.addChannel(targetNode, timestamps, values);
+        uncompressedUsage += uncompressed.getMemoryUsage();
+        ++channelCount;
+
+        // Step and cubic spline channels are not resampled
+        bool isLinear = sampler.interpolation.empty() || sampler.interpolation == "LINEAR";
+        std::size_t path = static_cast<std::size_t>(targetPath);
+        if(!isLinear ||
+           !AnimationCompression::compressChannel(targetNode, timestamps, values,
+                                                  Constants::ANIMATION_COMPRESSION_TOLERANCE,
+                                                  mCompressedChannels[path])) {
+            mChannels[path].addChannel(targetNode, timestamps, values);
+        }
     }
+
+    std::size_t compressedCount = 0;
+    for(const auto &group : mCompressedChannels) compressedCount += group.size();
+    Log::info() << "Animation '" << mName << "': " << compressedCount << "/" << channelCount
+                << " channels compressed, " << uncompressedUsage / 1024.0f << " KiB -> "
+                << getMemoryUsage() / 1024.0f << " KiB.";
 }
@@ -2,6 +2,7 @@
 
 #include <tiny_gltf.h>
 
+#include <array>
 #include <filesystem>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/vec3.hpp>
@@ -9,7 +10,9 @@
 #include <string>
 #include <vector>
 
+#include "AnimationCompression.hpp"
 #include "AnimationNode.hpp"
+#include "AnimationSampling.hpp"
 #include "Constants.hpp"
 
 class AnimationContainer;
@@ -18,19 +21,9 @@ public:
     using Ptr = std::shared_ptr<Animation>;
     using CPtr = std::shared_ptr<const Animation>;
 
-    enum class TargetPath { Translation, Rotation, Scale };
-
-    struct AnimationSampler {
-        std::vector<float> timestamps;
-        std::vector<glm::vec4> values; // Quaternion for rotation, vec3 for position/scale
-        std::string interpolation;
-    };
-
-    struct AnimationChannel {
-        AnimationNode* targetNode = nullptr;
-        TargetPath targetPath = TargetPath::Translation;
-        AnimationSampler sampler;
-    };
+    enum class TargetPath { Translation = 0, Rotation, Scale, COUNT };
+    using ChannelGroup = AnimationSampling::ChannelGroup;
+    using CompressedChannelGroup = AnimationCompression::CompressedChannelGroup;
 
     static Ptr create(AnimationContainer& container, const tinygltf::Model& model,
                       const tinygltf::Animation& animation) {
@@ -42,15 +35,31 @@ public:
 
     const std::string& getName() const { return mName; }
 
-    std::vector<AnimationChannel>& getChannels() { return mChannels; }
+    // Channels are grouped by target path. Channels which could not be compressed
+    // keep their keyframes and are sampled with keyframe cursors.
+    const ChannelGroup& getChannels(TargetPath path) const {
+        return mChannels[static_cast<std::size_t>(path)];
+    }
+    const CompressedChannelGroup& getCompressedChannels(TargetPath path) const {
+        return mCompressedChannels[static_cast<std::size_t>(path)];
+    }
+
+    // Uncompressed channels only
+    std::size_t getChannelCount() const {
+        std::size_t count = 0;
+        for(const auto& group : mChannels) count += group.size();
+        return count;
+    }
 
-    const std::vector<AnimationChannel>& getChannels() const { return mChannels; }
+    std::size_t getMemoryUsage() const;
 
     float getDuration() const { return mDuration; }
 
 private:
     std::string mName;
-    std::vector<AnimationChannel> mChannels;
+    std::array<ChannelGroup, static_cast<std::size_t>(TargetPath::COUNT)> mChannels;
+    std::array<CompressedChannelGroup, static_cast<std::size_t>(TargetPath::COUNT)>
+        mCompressedChannels;
     float mDuration{};
 
     void loadAnimationData(AnimationContainer& container, const tinygltf::Model& model,
@@ -0,0 +1,261 @@
+#include "AnimationCompression.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AnimationCompression {
+namespace {
+constexpr float QUAT_COMPONENT_RANGE = 0.70710678f; // Smallest three are within +-1/sqrt(2)
+constexpr std::uint16_t MAX_15_BITS = 0x7fff;
+constexpr std::uint16_t MAX_16_BITS = 0xffff;
+
+// Uniform rates tried in order, the first one within tolerance is kept
+constexpr float SAMPLE_RATES[] = {5.0f, 10.0f, 15.0f, 20.0f, 30.0f, 60.0f};
+
+// Stores the 3 smallest components in 15 bits each, the index of the largest one
+// (which is rebuilt from the unit length) in the remaining top bits.
+void encodeRotation(glm::vec4 rotation, std::uint16_t* out) {
+    rotation = glm::normalize(rotation);
+
+    int largest = 0;
+    for(int c = 1; c < 4; ++c) {
+        if(std::abs(rotation[c]) > std::abs(rotation[largest])) largest = c;
+    }
+    if(rotation[largest] < 0.0f) rotation = -rotation; // Same rotation
+
+    std::uint16_t packed[3];
+    for(int c = 0, j = 0; c < 4; ++c) {
+        if(c == largest) continue;
+        float normalized =
+            std::clamp(rotation[c] / (2.0f * QUAT_COMPONENT_RANGE) + 0.5f, 0.0f, 1.0f);
+        packed[j++] = static_cast<std::uint16_t>(std::lround(normalized * MAX_15_BITS));
+    }
+
+    out[0] = packed[0] | static_cast<std::uint16_t>((largest >> 1) << 15);
+    out[1] = packed[1] | static_cast<std::uint16_t>((largest & 1) << 15);
+    out[2] = packed[2];
+}
+
+glm::vec4 decodeRotation(const std::uint16_t* in) {
+    int largest = ((in[0] >> 15) << 1) | (in[1] >> 15);
+
+    glm::vec4 rotation;
+    float lengthSq = 0.0f;
+    for(int c = 0, j = 0; c < 4; ++c) {
+        if(c == largest) continue;
+        float value = (static_cast<float>(in[j++] & MAX_15_BITS) / MAX_15_BITS - 0.5f) *
+                      (2.0f * QUAT_COMPONENT_RANGE);
+        rotation[c] = value;
+        lengthSq += value * value;
+    }
+    rotation[largest] = std::sqrt(std::max(0.0f, 1.0f - lengthSq));
+    return rotation;
+}
+
+void encodeVector(const glm::vec4& value, const glm::vec3& min, const glm::vec3& extent,
+                  std::uint16_t* out) {
+    for(int c = 0; c < 3; ++c) {
+        float normalized =
+            extent[c] > 0.0f ? std::clamp((value[c] - min[c]) / extent[c], 0.0f, 1.0f)
+                             : 0.0f;
+        out[c] = static_cast<std::uint16_t>(std::lround(normalized * MAX_16_BITS));
+    }
+}
+
+glm::vec4 decodeVector(const std::uint16_t* in, const glm::vec3& min,
+                       const glm::vec3& extent) {
+    glm::vec4 value(0.0f);
+    for(int c = 0; c < 3; ++c) {
+        value[c] = min[c] + static_cast<float>(in[c]) / MAX_16_BITS * extent[c];
+    }
+    return value;
+}
+
+// Same interpolation as the runtime kernels, lerp or nlerp
+glm::vec4 interpolate(const glm::vec4& from, glm::vec4 to, float alpha, bool isRotation) {
+    if(!isRotation) return from + (to - from) * alpha;
+
+    if(glm::dot(from, to) < 0.0f) to = -to;
+    return glm::normalize(from + (to - from) * alpha);
+}
+
+float getError(const glm::vec4& a, const glm::vec4& b, bool isRotation) {
+    float error = glm::length(a - b);
+    return isRotation ? std::min(error, glm::length(a + b)) : error;
+}
+
+// Position of time in a uniformly sampled channel
+void locateSample(float time, float startTime, float sampleRate, std::uint32_t sampleCount,
+                  std::uint32_t& sample, std::uint32_t& nextSample, float& alpha) {
+    float position = std::clamp((time - startTime) * sampleRate, 0.0f,
+                                static_cast<float>(sampleCount - 1));
+    sample = std::min(static_cast<std::uint32_t>(position), sampleCount - 1);
+    nextSample = std::min(sample + 1, sampleCount - 1);
+    alpha = position - static_cast<float>(sample);
+}
+} // namespace
+
+std::size_t CompressedChannelGroup::getMemoryUsage() const {
+    return targetNodes.size() * sizeof(int) + startTimes.size() * sizeof(float) +
+           sampleRates.size() * sizeof(float) +
+           sampleOffsets.size() * sizeof(std::uint32_t) +
+           sampleCounts.size() * sizeof(std::uint32_t) +
+           rangeMins.size() * sizeof(glm::vec3) + rangeExtents.size() * sizeof(glm::vec3) +
+           samples.size() * sizeof(std::uint16_t);
+}
+
+bool compressChannel(int targetNode, const std::vector<float>& times,
+                     const std::vector<glm::vec4>& values, float tolerance,
+                     CompressedChannelGroup& group) {
+    const std::size_t keyCount = std::min(times.size(), values.size());
+    if(keyCount == 0) return false;
+
+    const bool isRotation = group.isRotation;
+    const float startTime = times.front();
+    const float duration = times[keyCount - 1] - startTime;
+
+    // Channel as sampled uncompressed
+    auto evaluate = [&](float time) {
+        auto next = std::upper_bound(times.begin(), times.begin() + keyCount, time);
+        if(next == times.begin()) return values.front();
+        if(next == times.begin() + keyCount) return values[keyCount - 1];
+
+        std::size_t key = next - times.begin() - 1;
+        float span = times[key + 1] - times[key];
+        float alpha = span > 0.0f ? (time - times[key]) / span : 0.0f;
+        return interpolate(values[key], values[key + 1], alpha, isRotation);
+    };
+
+    glm::vec3 min(values.front());
+    glm::vec3 max(values.front());
+    for(std::size_t i = 0; i < keyCount; ++i) {
+        min = glm::min(min, glm::vec3(values[i]));
+        max = glm::max(max, glm::vec3(values[i]));
+    }
+    const glm::vec3 extent = max - min;
+
+    auto encode = [&](const glm::vec4& value, std::uint16_t* out) {
+        isRotation ? encodeRotation(value, out) : encodeVector(value, min, extent, out);
+    };
+    auto decode = [&](const std::uint16_t* in) {
+        return isRotation ? decodeRotation(in) : decodeVector(in, min, extent);
+    };
+
+    std::vector<std::uint16_t> encoded;
+    auto tryIntervals = [&](std::uint32_t intervals) {
+        const std::uint32_t sampleCount = intervals + 1;
+        const float sampleRate = intervals > 0 ? intervals / duration : 0.0f;
+
+        encoded.resize(sampleCount * 3);
+        for(std::uint32_t s = 0; s < sampleCount; ++s) {
+            float time = intervals > 0 ? startTime + s / sampleRate : startTime;
+            encode(evaluate(time), &encoded[s * 3]);
+        }
+
+        auto decodeAt = [&](float time) {
+            std::uint32_t sample, nextSample;
+            float alpha;
+            locateSample(time, startTime, sampleRate, sampleCount, sample, nextSample,
+                         alpha);
+            return interpolate(decode(&encoded[sample * 3]),
+                               decode(&encoded[nextSample * 3]), alpha, isRotation);
+        };
+
+        // Both curves are piecewise linear, so the largest error is at a key or
+        // at a sample
+        for(std::size_t i = 0; i < keyCount; ++i) {
+            if(getError(decodeAt(times[i]), values[i], isRotation) > tolerance) {
+                return false;
+            }
+        }
+        for(std::uint32_t s = 1; s + 1 < sampleCount; ++s) {
+            float time = startTime + s / sampleRate;
+            if(getError(decodeAt(time), evaluate(time), isRotation) > tolerance) {
+                return false;
+            }
+        }
+
+        group.targetNodes.push_back(targetNode);
+        group.startTimes.push_back(startTime);
+        group.sampleRates.push_back(sampleRate);
+        group.sampleOffsets.push_back(static_cast<std::uint32_t>(group.samples.size() / 3));
+        group.sampleCounts.push_back(sampleCount);
+        group.rangeMins.push_back(isRotation ? glm::vec3(0.0f) : min);
+        group.rangeExtents.push_back(isRotation ? glm::vec3(0.0f) : extent);
+        group.samples.insert(group.samples.end(), encoded.begin(), encoded.end());
+        return true;
+    };
+
+    // Constant channel
+    if(tryIntervals(0)) return true;
+    if(duration <= 0.0f) return false;
+
+    std::uint32_t lastIntervals = 0;
+    for(float rate : SAMPLE_RATES) {
+        auto intervals = static_cast<std::uint32_t>(std::ceil(duration * rate - 0.001f));
+        intervals = std::max(intervals, 1u);
+
+        // Not worth it past a few samples per key
+        if(intervals + 1 > keyCount * 3) break;
+        if(intervals == lastIntervals) continue;
+        lastIntervals = intervals;
+
+        if(tryIntervals(intervals)) return true;
+    }
+    return false;
+}
+
+void gatherKeys(const CompressedChannelGroup& group, float time,
+                AnimationSampling::KeyPairs& keys, float loopDuration) {
+    const std::size_t count = group.size();
+    keys.resize(count);
+
+    for(std::size_t i = 0; i < count; ++i) {
+        std::uint32_t sample, nextSample;
+        float alpha;
+        const std::uint32_t sampleCount = group.sampleCounts[i];
+        const float startTime = group.startTimes[i];
+        const float endTime =
+            sampleCount > 1 ? startTime + (sampleCount - 1) / group.sampleRates[i]
+                            : startTime;
+        if(sampleCount > 1 && loopDuration > 0.0f &&
+           (time < startTime || time > endTime)) {
+            sample = sampleCount - 1;
+            nextSample = 0;
+            alpha = AnimationSampling::getSeamAlpha(time, startTime, endTime,
+                                                    loopDuration);
+        } else {
+            locateSample(time, startTime, group.sampleRates[i], sampleCount, sample,
+                         nextSample, alpha);
+        }
+
+        const std::uint16_t* samples = &group.samples[group.sampleOffsets[i] * 3];
+        glm::vec4 from, to;
+        if(group.isRotation) {
+            from = decodeRotation(&samples[sample * 3]);
+            to = decodeRotation(&samples[nextSample * 3]);
+        } else {
+            from = decodeVector(&samples[sample * 3], group.rangeMins[i],
+                                group.rangeExtents[i]);
+            to = decodeVector(&samples[nextSample * 3], group.rangeMins[i],
+                              group.rangeExtents[i]);
+        }
+
+        for(int c = 0; c < 4; ++c) {
+            keys.from[c][i] = from[c];
+            keys.to[c][i] = to[c];
+        }
+        keys.alpha[i] = alpha;
+    }
+}
+
+void sample(const CompressedChannelGroup& group, float time,
+            AnimationSampling::KeyPairs& scratch, glm::vec4* out, float loopDuration) {
+    gatherKeys(group, time, scratch, loopDuration);
+    if(group.isRotation) {
+        AnimationSampling::nlerp(scratch, group.size(), out);
+    } else {
+        AnimationSampling::lerp(scratch, group.size(), out);
+    }
+}
+} // namespace AnimationCompression
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "AnimationSampling.hpp"
+
+// Load-time compression of linear animation channels. Each channel is resampled
+// at the lowest uniform rate that stays within tolerance (a single sample if it
+// is constant), so sampling is a direct index instead of a key search. Samples
+// are quantized to 3 uint16 each: translations and scales within the channel's
+// bounds, rotations with the smallest-three encoding.
+namespace AnimationCompression {
+struct CompressedChannelGroup {
+    std::vector<int> targetNodes;              // Per channel, node index in container
+    std::vector<float> startTimes;             // Per channel
+    std::vector<float> sampleRates;            // Per channel, samples per second
+    std::vector<std::uint32_t> sampleOffsets;  // Per channel, first sample in samples
+    std::vector<std::uint32_t> sampleCounts;   // Per channel
+    std::vector<glm::vec3> rangeMins;          // Per channel, translation/scale only
+    std::vector<glm::vec3> rangeExtents;       // Per channel, translation/scale only
+    std::vector<std::uint16_t> samples;        // 3 values per sample
+    bool isRotation = false;
+
+    std::size_t size() const { return targetNodes.size(); }
+    std::size_t getMemoryUsage() const;
+};
+
+// Returns false if the channel could not be compressed within tolerance, in which
+// case it should be kept as is.
+bool compressChannel(int targetNode, const std::vector<float>& times,
+                     const std::vector<glm::vec4>& values, float tolerance,
+                     CompressedChannelGroup& group);
+
+// loopDuration works like in AnimationSampling::gatherKeys()
+void gatherKeys(const CompressedChannelGroup& group, float time,
+                AnimationSampling::KeyPairs& keys, float loopDuration = 0.0f);
+
+// Samples all channels of the group at the given time into out (group.size()
+// values)
+void sample(const CompressedChannelGroup& group, float time,
+            AnimationSampling::KeyPairs& scratch, glm::vec4* out,
+            float loopDuration = 0.0f);
+} // namespace AnimationCompression
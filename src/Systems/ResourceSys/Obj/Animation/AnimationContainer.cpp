@@ -15,6 +15,8 @@ AnimationContainer::AnimationContainer(const tinygltf::Model &model) {
         loadSkins(model);
         loadAnimations(model);
     }
+
+    mBindPose.reset(*this);
 }
 
 // Loads all nodes under the given parent node
@@ -29,9 +31,8 @@ void AnimationContainer::loadNodes(const tinygltf::Model &model, int parentNodeI
     }
     Log::debug() << "Loading nodes from parent node " << parentNodeIndex << ".";
 
-    std::stack<std::pair<int, AnimationNode *>>
-        stack; // Input node index, our parent node
-    stack.push({parentNodeIndex, nullptr});
+    std::stack<std::pair<int, int>> stack; // Input node index, our parent node index
+    stack.push({parentNodeIndex, -1});
 
     while(!stack.empty()) {
         auto [nodeIndex, parentNode] = stack.top();
@@ -40,29 +41,27 @@ void AnimationContainer::loadNodes(const tinygltf::Model &model, int parentNodeI
 
         const tinygltf::Node &node = model.nodes[nodeIndex];
 
-        // Create and add joint node
-        AnimationNode::Ptr newNode = std::make_unique<AnimationNode>();
-        AnimationNode *newNodePtr = newNode.get();
-        newNode->parent = parentNode;
-        newNode->translation = node.translation.empty()
+        // Create and add joint node. Since it is added after its parent, the array
+        // stays topologically sorted.
+        int newNodeIndex = static_cast<int>(mNodes.size());
+        AnimationNode &newNode = mNodes.emplace_back();
+        newNode.parent = parentNode;
+        newNode.translation = node.translation.empty()
                                    ? glm::vec3(0.0f)
                                    : glm::vec3(node.translation[0], node.translation[1],
                                                node.translation[2]);
-        newNode->rotation = node.rotation.empty()
+        newNode.rotation = node.rotation.empty()
                                 ? glm::quat(1.0f, 0.0f, 0.0f, 0.0f)
                                 : glm::quat(node.rotation[3], node.rotation[0],
                                             node.rotation[1], node.rotation[2]);
-        newNode->scale = node.scale.empty()
+        newNode.scale = node.scale.empty()
                              ? glm::vec3(1.0f)
                              : glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
 
-        if(parentNode)
-            parentNode->children.push_back(newNodePtr); // Add as child to parent
-        mGltfNodeIndexToNode.insert({nodeIndex, newNodePtr});
-        mNodes.push_back(std::move(newNode));
+        mGltfNodeIndexToNode.insert({nodeIndex, newNodeIndex});
 
         for(int childIndex : node.children) {
-            stack.push({childIndex, newNodePtr});
+            stack.push({childIndex, newNodeIndex});
         }
         mVisitedInputNodes.insert(nodeIndex);
     }
@@ -72,7 +71,7 @@ void AnimationContainer::loadSkins(const tinygltf::Model &model) {
     Log::debug() << "Loading " << model.skins.size() << " skins.";
     for(int i = 0; i < model.skins.size(); i++) {
         const tinygltf::Skin &skin = model.skins[i];
-        Skin::Ptr newSkin = Skin::create(*this, model, skin);
+        Skin::Ptr newSkin = Skin::create(*this, model, skin, i);
 
         mSkins.push_back(newSkin);
     }
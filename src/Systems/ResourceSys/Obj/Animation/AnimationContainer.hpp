@@ -12,6 +12,8 @@
 
 #include "Animation.hpp"
 #include "AnimationNode.hpp"
+#include "AnimationPose.hpp"
+#include "BakedAnimations.hpp"
 #include "Constants.hpp"
 #include "Log.hpp"
 #include "Skin.hpp"
@@ -27,7 +29,7 @@ public:
 
     AnimationContainer(const tinygltf::Model& model);
 
-    Animation* getAnimation(std::size_t nameIndex) {
+    const Animation* getAnimation(std::size_t nameIndex) const {
         if(nameIndex >= mAnimations.size()) {
             Log::error() << "Animation " << nameIndex << " out of bounds.";
             return nullptr;
@@ -43,32 +45,48 @@ public:
         return mAnimations[nameIndex].get();
     }
 
-    AnimationNode* getNode(int gltfNodeIndex) {
+    // Returns the index of the node in getNodes(), -1 if not found
+    int getNodeIndex(int gltfNodeIndex) const {
         auto it = mGltfNodeIndexToNode.find(gltfNodeIndex);
-        return it == mGltfNodeIndexToNode.end() ? nullptr : it->second;
+        return it == mGltfNodeIndexToNode.end() ? -1 : it->second;
     }
 
-    const AnimationNode* getNode(int gltfNodeIndex) const {
-        auto it = mGltfNodeIndexToNode.find(gltfNodeIndex);
-        return it == mGltfNodeIndexToNode.end() ? nullptr : it->second;
-    }
+    // Nodes in their bind pose, the animated state lives in an AnimationPose
+    const std::vector<AnimationNode>& getNodes() const { return mNodes; }
+    const AnimationPose& getBindPose() const { return mBindPose; }
 
-    Skin::Ptr getSkin(int skinIndex) {
+    Skin::CPtr getSkin(int skinIndex) const {
         if(skinIndex < 0) return nullptr;
         if(skinIndex >= mSkins.size()) return nullptr;
         return mSkins[skinIndex];
     }
 
-    std::vector<Skin::Ptr>& getSkins() { return mSkins; }
     const std::vector<Skin::Ptr>& getSkins() const { return mSkins; }
 
+    // By name index, nullptr for animations the model does not have
+    const std::array<Animation::Ptr, Constants::AnimationName::size()>& getAnimations()
+        const {
+        return mAnimations;
+    }
+
+    // Baked on first use, needs the GL context
+    const BakedAnimations& getBakedAnimations() const {
+        if(!mBakedAnimations) {
+            mBakedAnimations = std::make_unique<BakedAnimations>(
+                *this, Constants::BAKED_ANIMATION_SAMPLE_RATE);
+        }
+        return *mBakedAnimations;
+    }
+
 private:
-    std::vector<AnimationNode::Ptr> mNodes;
+    std::vector<AnimationNode> mNodes;           // Parents before children
+    AnimationPose mBindPose;
     std::unordered_set<int> mVisitedInputNodes;
-    std::unordered_map<int, AnimationNode*> mGltfNodeIndexToNode;
+    std::unordered_map<int, int> mGltfNodeIndexToNode;
     std::vector<Skin::Ptr> mSkins; // All skins
     std::array<Animation::Ptr, Constants::AnimationName::size()>
         mAnimations{}; // Animations mapped by name index
+    mutable std::unique_ptr<BakedAnimations> mBakedAnimations;
 
     void loadNodes(const tinygltf::Model& model, int parentNodeIndex);
     void loadSkins(const tinygltf::Model& model);
@@ -2,16 +2,12 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
-#include <memory>
-#include <vector>
 
-// In glTF, represents a node in the scene graph
+// In glTF, represents a node in the scene graph, in its bind pose. Nodes are stored
+// in a flat array by their AnimationContainer, sorted so that parents always come
+// before their children.
 struct AnimationNode {
-    using Ptr = std::unique_ptr<AnimationNode>;
-    using CPtr = std::unique_ptr<const AnimationNode>;
-
-    AnimationNode* parent = nullptr;
-    std::vector<AnimationNode*> children;
+    int parent = -1; // Index of parent node, -1 if root
     glm::vec3 translation{};
     glm::quat rotation{};
     glm::vec3 scale{};
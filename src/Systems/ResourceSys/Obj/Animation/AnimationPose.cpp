@@ -0,0 +1,111 @@
+#include "AnimationPose.hpp"
+
+#include <atomic>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Animation.hpp"
+#include "AnimationContainer.hpp"
+
+namespace {
+// Writes sampled values to the nodes they target
+void applySampledValues(AnimationPose& pose, Animation::TargetPath path,
+                        const std::vector<int>& targetNodes,
+                        const std::vector<glm::vec4>& values, float blendFactor) {
+    using TargetPath = Animation::TargetPath;
+    for(std::size_t i = 0; i < targetNodes.size(); ++i) {
+        std::size_t node = targetNodes[i];
+        const glm::vec4& value = values[i];
+
+        if(path == TargetPath::Translation) {
+            pose.translations[node] =
+                glm::mix(pose.translations[node], glm::vec3(value), blendFactor);
+        } else if(path == TargetPath::Rotation) {
+            glm::quat rotation = glm::quat(value.w, value.x, value.y, value.z);
+            pose.rotations[node] =
+                blendFactor < 1.0f ? glm::slerp(pose.rotations[node], rotation, blendFactor)
+                                   : rotation;
+        } else {
+            pose.scales[node] = glm::mix(pose.scales[node], glm::vec3(value), blendFactor);
+        }
+    }
+}
+} // namespace
+
+// Sets the pose to the bind pose of the container
+void AnimationPose::reset(const AnimationContainer& animationContainer) {
+    container = &animationContainer;
+
+    const std::vector<AnimationNode>& nodes = container->getNodes();
+    translations.resize(nodes.size());
+    rotations.resize(nodes.size());
+    scales.resize(nodes.size());
+    globalTransforms.resize(nodes.size());
+    for(std::size_t i = 0; i < nodes.size(); ++i) {
+        translations[i] = nodes[i].translation;
+        rotations[i] = nodes[i].rotation;
+        scales[i] = nodes[i].scale;
+    }
+
+    skinTransforms.resize(container->getSkins().size());
+    updateTransforms();
+}
+
+// Samples the animation at the given time into the local transforms. Blend factor
+// dictates how much the current pose is blended with the new pose: 0 leaves it
+// unchanged, 1 replaces it. Looping animations interpolate from their last keys back
+// to their first ones across the seam. keyframeCursors is kept between calls for the same
+// instance, scratch and sampledValues only avoid allocations.
+void AnimationPose::applyAnimation(const Animation& animation, float time,
+                                   float blendFactor, bool isLooping,
+                                   std::vector<std::uint32_t>& keyframeCursors,
+                                   AnimationSampling::KeyPairs& scratch,
+                                   std::vector<glm::vec4>& sampledValues) {
+    using TargetPath = Animation::TargetPath;
+    const float loopDuration = isLooping ? animation.getDuration() : 0.0f;
+
+    // Cursors of all groups, back to back
+    keyframeCursors.resize(animation.getChannelCount());
+    std::uint32_t* cursors = keyframeCursors.data();
+
+    for(TargetPath path : {TargetPath::Translation, TargetPath::Rotation, TargetPath::Scale}) {
+        const Animation::ChannelGroup& channels = animation.getChannels(path);
+        sampledValues.resize(channels.size());
+        AnimationSampling::sample(channels, time, cursors, scratch, sampledValues.data(),
+                                  path == TargetPath::Rotation, loopDuration);
+        cursors += channels.size();
+        applySampledValues(*this, path, channels.targetNodes, sampledValues, blendFactor);
+
+        const Animation::CompressedChannelGroup& compressedChannels =
+            animation.getCompressedChannels(path);
+        sampledValues.resize(compressedChannels.size());
+        AnimationCompression::sample(compressedChannels, time, scratch,
+                                     sampledValues.data(), loopDuration);
+        applySampledValues(*this, path, compressedChannels.targetNodes, sampledValues,
+                           blendFactor);
+    }
+}
+
+// Computes global transforms in a single forward pass (parents are before their
+// children), then the palette of each skin
+void AnimationPose::updateTransforms() {
+    static std::atomic<std::uint64_t> nextVersion{1};
+
+    if(!container) return;
+    version = nextVersion.fetch_add(1, std::memory_order_relaxed);
+
+    const std::vector<AnimationNode>& nodes = container->getNodes();
+    for(std::size_t i = 0; i < nodes.size(); ++i) {
+        glm::mat4 localTransform = glm::translate(glm::mat4(1.0f), translations[i]) *
+                                   glm::mat4_cast(rotations[i]) *
+                                   glm::scale(glm::mat4(1.0f), scales[i]);
+
+        int parent = nodes[i].parent;
+        globalTransforms[i] =
+            parent < 0 ? localTransform : globalTransforms[parent] * localTransform;
+    }
+
+    const auto& skins = container->getSkins();
+    for(std::size_t i = 0; i < skins.size(); ++i) {
+        skins[i]->computeTransforms(globalTransforms, skinTransforms[i]);
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+#include "AnimationSampling.hpp"
+
+class Animation;
+class AnimationContainer;
+
+// Animated state of one instance of an AnimationContainer, so many entities can
+// share the same loaded model. The container only holds the immutable skeleton
+// (bind pose) and clips.
+struct AnimationPose {
+    // Local transform of each node, indexed like AnimationContainer::getNodes()
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+
+    std::vector<glm::mat4> globalTransforms;            // Model space, per node
+    std::vector<std::vector<glm::mat4>> skinTransforms; // Joint palette, per skin
+
+    const AnimationContainer* container = nullptr; // Container this pose is for
+    // New value every time transforms are updated, from a counter shared by all poses,
+    // so equal versions mean equal transforms (copies of a pose keep its version)
+    std::uint64_t version = 0;
+
+    void reset(const AnimationContainer& animationContainer);
+    void applyAnimation(const Animation& animation, float time, float blendFactor,
+                        bool isLooping, std::vector<std::uint32_t>& keyframeCursors,
+                        AnimationSampling::KeyPairs& scratch,
+                        std::vector<glm::vec4>& sampledValues);
+    void updateTransforms();
+};
@@ -0,0 +1,176 @@
+#include "AnimationSampling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define ANIMATION_SAMPLING_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace AnimationSampling {
+void ChannelGroup::addChannel(int targetNode, const std::vector<float>& channelTimes,
+                              const std::vector<glm::vec4>& channelValues) {
+    std::size_t keyCount = std::min(channelTimes.size(), channelValues.size());
+    if(keyCount == 0) return;
+
+    targetNodes.push_back(targetNode);
+    keyOffsets.push_back(static_cast<std::uint32_t>(times.size()));
+    keyCounts.push_back(static_cast<std::uint32_t>(keyCount));
+    times.insert(times.end(), channelTimes.begin(), channelTimes.begin() + keyCount);
+    values.insert(values.end(), channelValues.begin(), channelValues.begin() + keyCount);
+}
+
+std::size_t ChannelGroup::getMemoryUsage() const {
+    return targetNodes.size() * sizeof(int) + keyOffsets.size() * sizeof(std::uint32_t) +
+           keyCounts.size() * sizeof(std::uint32_t) + times.size() * sizeof(float) +
+           values.size() * sizeof(glm::vec4);
+}
+
+void KeyPairs::resize(std::size_t count) {
+    for(int c = 0; c < 4; ++c) {
+        from[c].resize(count);
+        to[c].resize(count);
+    }
+    alpha.resize(count);
+}
+
+float getSeamAlpha(float time, float firstTime, float lastTime, float loopDuration) {
+    float seam = firstTime + loopDuration - lastTime;
+    float elapsed = time < firstTime ? time + loopDuration - lastTime : time - lastTime;
+    return seam > 0.0f ? std::clamp(elapsed / seam, 0.0f, 1.0f) : 0.0f;
+}
+
+void gatherKeys(const ChannelGroup& group, float time, std::uint32_t* cursors,
+                KeyPairs& keys, float loopDuration) {
+    const std::size_t count = group.size();
+    keys.resize(count);
+
+    float* from[4] = {keys.from[0].data(), keys.from[1].data(), keys.from[2].data(),
+                      keys.from[3].data()};
+    float* to[4] = {keys.to[0].data(), keys.to[1].data(), keys.to[2].data(),
+                    keys.to[3].data()};
+    float* alphas = keys.alpha.data();
+
+    for(std::size_t i = 0; i < count; ++i) {
+        const float* times = group.times.data() + group.keyOffsets[i];
+        const glm::vec4* values = group.values.data() + group.keyOffsets[i];
+        const std::uint32_t keyCount = group.keyCounts[i];
+
+        std::uint32_t key = 0;
+        std::uint32_t nextKey = 0;
+        float alpha = 0.0f;
+        if(keyCount > 1 && loopDuration > 0.0f &&
+           (time < times[0] || time > times[keyCount - 1])) {
+            key = keyCount - 1;
+            alpha = getSeamAlpha(time, times[0], times[key], loopDuration);
+        } else if(keyCount > 1) {
+            // Resume from the last key, restart if time went backwards (looped)
+            key = cursors[i];
+            if(key + 1 >= keyCount || times[key] > time) key = 0;
+            while(key + 2 < keyCount && times[key + 1] <= time) ++key;
+            nextKey = key + 1;
+
+            // Avoid division by zero (if two keyframes have the same time)
+            float span = times[nextKey] - times[key];
+            alpha = span > 0.0f ? std::clamp((time - times[key]) / span, 0.0f, 1.0f)
+                                : 0.0f;
+        }
+        cursors[i] = key;
+
+        const float* fromValue = &values[key][0];
+        const float* toValue = &values[nextKey][0];
+        for(int c = 0; c < 4; ++c) {
+            from[c][i] = fromValue[c];
+            to[c][i] = toValue[c];
+        }
+        alphas[i] = alpha;
+    }
+}
+
+void lerp(const KeyPairs& keys, std::size_t count, glm::vec4* out) {
+    std::size_t i = 0;
+#ifdef ANIMATION_SAMPLING_SSE
+    for(; i + 4 <= count; i += 4) {
+        __m128 alpha = _mm_loadu_ps(&keys.alpha[i]);
+        __m128 result[4];
+        for(int c = 0; c < 4; ++c) {
+            __m128 from = _mm_loadu_ps(&keys.from[c][i]);
+            __m128 to = _mm_loadu_ps(&keys.to[c][i]);
+            result[c] = _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), alpha));
+        }
+
+        // Back to one vec4 per channel
+        _MM_TRANSPOSE4_PS(result[0], result[1], result[2], result[3]);
+        for(int j = 0; j < 4; ++j) {
+            _mm_storeu_ps(&out[i + j][0], result[j]);
+        }
+    }
+#endif
+    for(; i < count; ++i) {
+        for(int c = 0; c < 4; ++c) {
+            float from = keys.from[c][i];
+            out[i][c] = from + (keys.to[c][i] - from) * keys.alpha[i];
+        }
+    }
+}
+
+// Normalized lerp, close enough to slerp between neighbouring keys
+void nlerp(const KeyPairs& keys, std::size_t count, glm::vec4* out) {
+    std::size_t i = 0;
+#ifdef ANIMATION_SAMPLING_SSE
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for(; i + 4 <= count; i += 4) {
+        __m128 alpha = _mm_loadu_ps(&keys.alpha[i]);
+        __m128 from[4];
+        __m128 to[4];
+        __m128 dot = _mm_setzero_ps();
+        for(int c = 0; c < 4; ++c) {
+            from[c] = _mm_loadu_ps(&keys.from[c][i]);
+            to[c] = _mm_loadu_ps(&keys.to[c][i]);
+            dot = _mm_add_ps(dot, _mm_mul_ps(from[c], to[c]));
+        }
+
+        // Take the shortest path, flip the target when the dot product is negative
+        __m128 flip = _mm_and_ps(dot, signMask);
+        __m128 lengthSq = _mm_setzero_ps();
+        __m128 result[4];
+        for(int c = 0; c < 4; ++c) {
+            __m128 target = _mm_xor_ps(to[c], flip);
+            result[c] = _mm_add_ps(from[c], _mm_mul_ps(_mm_sub_ps(target, from[c]), alpha));
+            lengthSq = _mm_add_ps(lengthSq, _mm_mul_ps(result[c], result[c]));
+        }
+
+        __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+        for(int c = 0; c < 4; ++c) {
+            result[c] = _mm_mul_ps(result[c], invLength);
+        }
+
+        _MM_TRANSPOSE4_PS(result[0], result[1], result[2], result[3]);
+        for(int j = 0; j < 4; ++j) {
+            _mm_storeu_ps(&out[i + j][0], result[j]);
+        }
+    }
+#endif
+    for(; i < count; ++i) {
+        glm::vec4 from(keys.from[0][i], keys.from[1][i], keys.from[2][i],
+                       keys.from[3][i]);
+        glm::vec4 to(keys.to[0][i], keys.to[1][i], keys.to[2][i], keys.to[3][i]);
+        if(glm::dot(from, to) < 0.0f) to = -to;
+
+        glm::vec4 result = from + (to - from) * keys.alpha[i];
+        out[i] = result / std::sqrt(glm::dot(result, result));
+    }
+}
+
+void sample(const ChannelGroup& group, float time, std::uint32_t* cursors,
+            KeyPairs& scratch, glm::vec4* out, bool isRotation, float loopDuration) {
+    gatherKeys(group, time, cursors, scratch, loopDuration);
+    if(isRotation) {
+        nlerp(scratch, group.size(), out);
+    } else {
+        lerp(scratch, group.size(), out);
+    }
+}
+} // namespace AnimationSampling
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Keyframe sampling of many channels at once. Channels sharing a target path are
+// stored as a structure of arrays, and interpolation runs 4 channels per
+// iteration with SSE when available.
+namespace AnimationSampling {
+struct ChannelGroup {
+    std::vector<int> targetNodes;          // Per channel, node index in container
+    std::vector<std::uint32_t> keyOffsets; // Per channel, first key in times/values
+    std::vector<std::uint32_t> keyCounts;  // Per channel
+    std::vector<float> times;              // Per key, all channels concatenated
+    std::vector<glm::vec4> values;         // Per key, quaternions stored as xyzw
+
+    std::size_t size() const { return targetNodes.size(); }
+    std::size_t getMemoryUsage() const;
+    void addChannel(int targetNode, const std::vector<float>& channelTimes,
+                    const std::vector<glm::vec4>& channelValues);
+};
+
+// Scratch space, keys to interpolate between for each channel
+struct KeyPairs {
+    std::vector<float> from[4]; // x, y, z, w
+    std::vector<float> to[4];
+    std::vector<float> alpha;
+
+    void resize(std::size_t count);
+};
+
+// A loopDuration above 0 interpolates from the last key back to the first outside of
+// the keys, like a looping clip does at its seam. Otherwise the end keys are held.
+void gatherKeys(const ChannelGroup& group, float time, std::uint32_t* cursors,
+                KeyPairs& keys, float loopDuration = 0.0f);
+void lerp(const KeyPairs& keys, std::size_t count, glm::vec4* out);
+void nlerp(const KeyPairs& keys, std::size_t count, glm::vec4* out);
+// Alpha from the last key (at lastTime) to the first one (at firstTime), across the
+// seam of a clip looping every loopDuration
+float getSeamAlpha(float time, float firstTime, float lastTime, float loopDuration);
+
+// Samples all channels of the group at the given time into out (group.size()
+// values). cursors (group.size() values) hold the last key used by each channel,
+// which makes monotonic playback a constant time lookup.
+void sample(const ChannelGroup& group, float time, std::uint32_t* cursors,
+            KeyPairs& scratch, glm::vec4* out, bool isRotation,
+            float loopDuration = 0.0f);
+} // namespace AnimationSampling
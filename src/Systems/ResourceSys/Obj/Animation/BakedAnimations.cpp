@@ -0,0 +1,116 @@
+#include "BakedAnimations.hpp"
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "AnimationContainer.hpp"
+#include "AnimationPose.hpp"
+#include "Log.hpp"
+
+BakedAnimations::BakedAnimations(const AnimationContainer& container, float sampleRate)
+    : mSampleRate(sampleRate) {
+    constexpr int TEXELS_PER_JOINT = 3;
+
+    // Layout
+    int width = 0;
+    for(const auto& skin : container.getSkins()) {
+        mSkinColumns.push_back(width);
+        width += static_cast<int>(skin->getJoints().size()) * TEXELS_PER_JOINT;
+    }
+
+    int height = 0;
+    const auto& animations = container.getAnimations();
+    mClips.resize(animations.size());
+    for(std::size_t i = 0; i < animations.size(); ++i) {
+        if(!animations[i]) continue;
+
+        Clip& clip = mClips[i];
+        clip.firstRow = height;
+        clip.duration = animations[i]->getDuration();
+        clip.frameCount =
+            static_cast<int>(std::ceil(clip.duration * mSampleRate - 0.001f)) + 1;
+        height += clip.frameCount;
+    }
+
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    if(width == 0 || height == 0) {
+        Log::warn() << "No skins or animations to bake.";
+        mClips.clear();
+        return;
+    }
+    if(width > maxTextureSize || height > maxTextureSize) {
+        Log::error() << "Baked animations do not fit in a " << maxTextureSize << "x"
+                     << maxTextureSize << " texture (" << width << "x" << height << ")!";
+        mClips.clear();
+        return;
+    }
+
+    // Sample every clip from the bind pose
+    std::vector<glm::vec4> texels(static_cast<std::size_t>(width) * height);
+    AnimationPose pose;
+    std::vector<std::uint32_t> keyframeCursors;
+    AnimationSampling::KeyPairs scratch;
+    std::vector<glm::vec4> sampledValues;
+
+    for(std::size_t i = 0; i < animations.size(); ++i) {
+        if(!animations[i]) continue;
+
+        const Clip& clip = mClips[i];
+        pose.reset(container);
+        keyframeCursors.clear();
+        for(int frame = 0; frame < clip.frameCount; ++frame) {
+            // Evenly spaced, the last row wraps around to the start of the clip so the
+            // shader interpolates across the seam
+            float time = frame / mSampleRate;
+            if(clip.duration > 0.0f) time = std::fmod(time, clip.duration);
+            // Baked clips always loop
+            pose.applyAnimation(*animations[i], time, 1.0f, true, keyframeCursors,
+                                scratch, sampledValues);
+            pose.updateTransforms();
+
+            glm::vec4* row = &texels[static_cast<std::size_t>(clip.firstRow + frame) * width];
+            for(std::size_t skin = 0; skin < pose.skinTransforms.size(); ++skin) {
+                const std::vector<glm::mat4>& transforms = pose.skinTransforms[skin];
+                for(std::size_t joint = 0; joint < transforms.size(); ++joint) {
+                    // Affine, the last row is always (0, 0, 0, 1)
+                    glm::mat4 rows = glm::transpose(transforms[joint]);
+                    glm::vec4* jointTexels =
+                        &row[mSkinColumns[skin] + joint * TEXELS_PER_JOINT];
+                    jointTexels[0] = rows[0];
+                    jointTexels[1] = rows[1];
+                    jointTexels[2] = rows[2];
+                }
+            }
+        }
+    }
+
+    glGenTextures(1, &mTextureId);
+    glBindTexture(GL_TEXTURE_2D, mTextureId);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT,
+                 texels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    Log::debug() << "Baked animations into a " << width << "x" << height << " texture ("
+                 << texels.size() * sizeof(glm::vec4) / 1024 << " KiB).";
+}
+
+BakedAnimations::~BakedAnimations() {
+    if(mTextureId) {
+        glDeleteTextures(1, &mTextureId);
+    }
+}
+
+const BakedAnimations::Clip* BakedAnimations::getClip(std::size_t animationNameIndex) const {
+    if(animationNameIndex >= mClips.size() || mClips[animationNameIndex].frameCount == 0) {
+        return nullptr;
+    }
+    return &mClips[animationNameIndex];
+}
+
+int BakedAnimations::getSkinColumn(std::size_t skinIndex) const {
+    return skinIndex < mSkinColumns.size() ? mSkinColumns[skinIndex] : 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+class AnimationContainer;
+
+// Joint palettes of every clip of a container, sampled at a fixed rate into a
+// float texture, so skinned instances can be animated entirely on the GPU.
+// Each row is one frame of a clip, the last one wrapping around to its start. Each
+// joint takes 3 texels (the first 3 rows of its matrix), skins being back to back.
+class BakedAnimations {
+public:
+    struct Clip {
+        int firstRow = 0;
+        int frameCount = 0;
+        float duration = 0.0f;
+    };
+
+    BakedAnimations(const AnimationContainer& container, float sampleRate);
+    ~BakedAnimations();
+    BakedAnimations(const BakedAnimations&) = delete;
+    BakedAnimations& operator=(const BakedAnimations&) = delete;
+
+    GLuint getTextureId() const { return mTextureId; }
+    float getSampleRate() const { return mSampleRate; }
+
+    // nullptr if the container has no such animation
+    const Clip* getClip(std::size_t animationNameIndex) const;
+    // First texel column of the skin's joints
+    int getSkinColumn(std::size_t skinIndex) const;
+
+private:
+    GLuint mTextureId = 0;
+    float mSampleRate;
+    std::vector<Clip> mClips; // By animation name index, frameCount 0 if missing
+    std::vector<int> mSkinColumns;
+};
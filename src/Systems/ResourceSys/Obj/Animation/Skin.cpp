@@ -2,71 +2,36 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp> // Required for glm::value_ptr
-#include <stack>
 
 #include "AnimationContainer.hpp"
 #include "AnimationNode.hpp"
 #include "Log.hpp"
 
 Skin::Skin(AnimationContainer &container, const tinygltf::Model &model,
-           const tinygltf::Skin &skin) {
+           const tinygltf::Skin &skin, std::size_t index)
+    : mIndex(index) {
     load(container, model, skin);
-    
-    std::unordered_map<AnimationNode *, glm::mat4> emptyCachedTransforms;
-    updateTransformBuffer(emptyCachedTransforms);
 }
 
-// cachedTransforms contains already calculated transforms for each joint, if present
-void Skin::updateTransformBuffer(
-    std::unordered_map<AnimationNode *, glm::mat4> &cachedTransforms) {
-    std::vector<glm::mat4> outTransforms;
-    outTransforms.reserve(mJoints.size());
+// globalTransforms contains the model space transform of each node of the container
+void Skin::computeTransforms(const std::vector<glm::mat4> &globalTransforms,
+                             std::vector<glm::mat4> &outTransforms) const {
+    outTransforms.resize(mJoints.size());
 
-    // Apply all joints transformations, from root to joint[i]
     for(std::size_t i = 0; i < mJoints.size(); i++) {
-        std::stack<AnimationNode *> stack;
-        glm::mat4 accumulatedTransform = glm::mat4(1.0f);
-        AnimationNode *joint = mJoints[i];
-
-        // Go up the hierarchy
-        // If we hit a joint that has already been processed, we can use its cached
-        // transform
-        while(joint != nullptr) {
-            if(cachedTransforms.find(joint) != cachedTransforms.end()) {
-                accumulatedTransform = cachedTransforms[joint];
-                break;
-            }
-
-            stack.push(joint);
-            joint = joint->parent;
-        }
-
-        // Apply from root (or after last cached) to joint
-        while(!stack.empty()) {
-            joint = stack.top();
-            stack.pop();
-
-            glm::mat4 localTransform = glm::mat4(1.0f);
-            localTransform = glm::translate(glm::mat4(1.0f), joint->translation) *
-                             glm::mat4_cast(joint->rotation) *
-                             glm::scale(glm::mat4(1.0f), joint->scale);
-
-            accumulatedTransform = accumulatedTransform * localTransform;
-            cachedTransforms.insert({joint, accumulatedTransform});
-            joint = joint->parent;
-        }
-
-        accumulatedTransform = accumulatedTransform * mInverseBindMatrices[i];
-        outTransforms.push_back(accumulatedTransform);
+        glm::mat4 jointTransform =
+            mJoints[i] < 0 ? glm::mat4(1.0f) : globalTransforms[mJoints[i]];
+        outTransforms[i] = i < mInverseBindMatrices.size()
+                               ? jointTransform * mInverseBindMatrices[i]
+                               : jointTransform;
     }
-    mTransformBuffer.setData(GL_UNIFORM_BUFFER, outTransforms);
 }
 
 void Skin::load(AnimationContainer &container, const tinygltf::Model &model,
                 const tinygltf::Skin &skin) {
     // Load joints
     for(const auto &joint : skin.joints) {
-        mJoints.push_back(container.getNode(joint));
+        mJoints.push_back(container.getNodeIndex(joint));
     }
 
     // Load inverse bind matrices
@@ -13,7 +13,6 @@
 
 #include "AnimationNode.hpp"
 #include "Constants.hpp"
-#include "Systems/ResourceSys/Obj/GPUBuffer.hpp"
 
 class AnimationContainer;
 class Node;
@@ -23,22 +22,22 @@ public:
     using CPtr = std::shared_ptr<const Skin>;
 
     static Ptr create(AnimationContainer& container, const tinygltf::Model& model,
-                      const tinygltf::Skin& skin) {
-        return std::make_shared<Skin>(container, model, skin);
+                      const tinygltf::Skin& skin, std::size_t index) {
+        return std::make_shared<Skin>(container, model, skin, index);
     }
 
     Skin(AnimationContainer& container, const tinygltf::Model& model,
-         const tinygltf::Skin& skin);
-    void updateTransformBuffer(
-        std::unordered_map<AnimationNode*, glm::mat4>& cachedTransforms);
+         const tinygltf::Skin& skin, std::size_t index);
+    void computeTransforms(const std::vector<glm::mat4>& globalTransforms,
+                           std::vector<glm::mat4>& outTransforms) const;
 
-    const std::vector<AnimationNode*>& getJoints() const { return mJoints; }
-    const GPUBuffer& getTransformBuffer() const { return mTransformBuffer; }
+    std::size_t getIndex() const { return mIndex; }
+    const std::vector<int>& getJoints() const { return mJoints; }
 
 private:
-    std::vector<AnimationNode*> mJoints;         // Nodes in the skeleton
+    std::vector<int> mJoints;                    // Node indices of the skeleton
     std::vector<glm::mat4> mInverseBindMatrices; // Inverse bind matrices for each joint
-    GPUBuffer mTransformBuffer;                  // Transform matrices for each joint
+    std::size_t mIndex;                          // Index in container
 
     void load(AnimationContainer& container, const tinygltf::Model& model,
               const tinygltf::Skin& skin);
@@ -6,23 +6,7 @@ GPUBuffer::GPUBuffer() { glGenBuffers(1, &mId); }
 
 GPUBuffer::~GPUBuffer() { glDeleteBuffers(1, &mId); }
 
-GPUBuffer::GPUBuffer(const GPUBuffer& other) : mSize(other.mSize) {
-    glGenBuffers(1, &mId);
-    if(mSize == 0) return;
-
-    // Bind the source buffer for reading
-    glBindBuffer(GL_COPY_READ_BUFFER, other.mId);
-    // Allocate data for the new buffer
-    glBindBuffer(GL_COPY_WRITE_BUFFER, mId);
-    glBufferData(GL_COPY_WRITE_BUFFER, mSize, nullptr, GL_STATIC_DRAW);
-
-    // Copy data
-    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, mSize);
-
-    // Unbind buffers
-    glBindBuffer(GL_COPY_READ_BUFFER, 0);
-    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
-}
+GPUBuffer::GPUBuffer(const GPUBuffer& other) : GPUBuffer() { setData(other); }
 
 GPUBuffer::GPUBuffer(GPUBuffer&& other) noexcept : GPUBuffer() { swap(*this, other); }
 
@@ -43,6 +27,25 @@ void swap(GPUBuffer& first, GPUBuffer& second) noexcept {
     std::swap(first.mSize, second.mSize);
 }
 
+void GPUBuffer::setData(const GPUBuffer& source, GLenum usageHint) {
+    mCount = source.mCount;
+    mSize = source.mSize;
+    if(mSize == 0) return;
+
+    // Bind the source buffer for reading
+    glBindBuffer(GL_COPY_READ_BUFFER, source.mId);
+    // Allocate data for the new buffer
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mId);
+    glBufferData(GL_COPY_WRITE_BUFFER, mSize, nullptr, usageHint);
+
+    // Copy data
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, mSize);
+
+    // Unbind buffers
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
 GLuint GPUBuffer::getId() const { return mId; }
 
 // Returns the number of elements in buffer
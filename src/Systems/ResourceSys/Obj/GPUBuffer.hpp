@@ -2,6 +2,7 @@
 
 #include <glad/glad.h>
 
+#include <span>
 #include <vector>
 
 // Simple OpenGL buffer wrapper for RAII
@@ -26,9 +27,16 @@ public:
     size_t getCount() const;
     size_t getSize() const;
 
+    // Copies the contents of another buffer, on the GPU
+    void setData(const GPUBuffer& source, GLenum usageHint = GL_STATIC_DRAW);
     template <typename T>
     void setData(GLenum target, const std::vector<T>& data,
                  GLenum usageHint = GL_STATIC_DRAW) {
+        setData(target, std::span<const T>(data), usageHint);
+    }
+    template <typename T>
+    void setData(GLenum target, std::span<const T> data,
+                 GLenum usageHint = GL_STATIC_DRAW) {
         if(data.empty()) return;
 
         glBindBuffer(target, mId);
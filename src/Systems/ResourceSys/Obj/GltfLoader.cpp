@@ -1,64 +1,262 @@
 #include "GltfLoader.hpp"
 
 #include <glad/glad.h>
-#include <stb_image.h> // Used by TinyGLTF
-
+#include <meshoptimizer.h>
+#include <nlohmann/json.hpp> // Used by TinyGLTF
+#include <stb_image.h>       // Used by TinyGLTF
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <glm/glm.hpp>
+#include <limits>
+#include <span>
 #include <stack>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 #include <utility>
 
 #include "Animation/Animation.hpp"
+#include "Constants.hpp"
 #include "Log.hpp"
 #include "ObjMaterial.hpp"
 #include "ObjMesh.hpp"
 #include "ObjResource.hpp"
+#include "TextureCache.hpp"
+#include "TextureCompression.hpp"
+#include "TextureStreamer.hpp"
+#include "TextureUploader.hpp"
+#include "Utils/HashUtils.hpp"
 #include "WavefrontLoader.hpp"
 
 namespace {
-template <typename T>
-void extractAttribute(const tinygltf::Primitive& primitive, const tinygltf::Model& model,
-                      const std::string& attribute, std::vector<T>& output) {
+constexpr const char* MESHOPT_COMPRESSION = "EXT_meshopt_compression";
+// Quantized attributes are handled by streamAttribute()
+constexpr const char* MESH_QUANTIZATION = "KHR_mesh_quantization";
+
+constexpr std::size_t GLB_HEADER_SIZE = 12;
+constexpr std::size_t GLB_CHUNK_HEADER_SIZE = 8;
+
+// Name the binary chunk of a GLB is served as, when its patched JSON is loaded as a
+// .gltf. See patchFallbackBuffers().
+constexpr const char* GLB_BINARY_CHUNK_URI = "vroom-glb-binary-chunk.bin";
+
+// TinyGLTF rejects meshopt fallback buffers, which have no uri and, in a GLB, are
+// larger than the binary chunk. Gives them a one byte data uri instead, as
+// decodeCompressedBufferViews() sizes them. Only the JSON is patched: a GLB's buffer 0
+// gets GLB_BINARY_CHUNK_URI, and binaryChunk is set to its data within the file.
+// Returns the patched JSON, or nothing if there is no fallback buffer.
+std::string patchFallbackBuffers(std::span<const unsigned char> file, bool isAscii,
+                                 std::span<const unsigned char>& binaryChunk) {
+    std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+    if(!isAscii) {
+        // Header, then the JSON and binary chunks, each after its own header
+        std::uint32_t jsonSize = 0;
+        if(file.size() >= GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE) {
+            std::memcpy(&jsonSize, file.data() + GLB_HEADER_SIZE, sizeof(jsonSize));
+        }
+        std::size_t jsonOffset = GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE;
+        if(jsonOffset > file.size() || jsonSize > file.size() - jsonOffset) return {};
+        text = text.substr(jsonOffset, jsonSize);
+
+        std::size_t binaryOffset = jsonOffset + jsonSize + GLB_CHUNK_HEADER_SIZE;
+        if(binaryOffset <= file.size()) {
+            std::uint32_t binarySize = 0;
+            std::memcpy(&binarySize, file.data() + jsonOffset + jsonSize,
+                        sizeof(binarySize));
+            binaryChunk = file.subspan(binaryOffset);
+            if(binarySize < binaryChunk.size()) {
+                binaryChunk = binaryChunk.first(binarySize);
+            }
+        }
+    }
+    if(text.find(MESHOPT_COMPRESSION) == std::string_view::npos) return {};
+
+    nlohmann::json json = nlohmann::json::parse(text, nullptr, false);
+    if(json.is_discarded() || !json.contains("buffers") || !json["buffers"].is_array()) {
+        return {};
+    }
+    nlohmann::json& buffers = json["buffers"];
+    bool isPatched = false;
+    for(nlohmann::json& buffer : buffers) {
+        auto extensions = buffer.find("extensions");
+        if(buffer.contains("uri") || extensions == buffer.end()) continue;
+        auto extension = extensions->find(MESHOPT_COMPRESSION);
+        if(extension == extensions->end()) continue;
+        auto fallback = extension->find("fallback");
+        if(fallback == extension->end() || *fallback != true) continue;
+
+        buffer["uri"] = "data:application/octet-stream;base64,AA==";
+        buffer["byteLength"] = 1;
+        isPatched = true;
+    }
+    if(!isPatched) return {};
+
+    nlohmann::json& firstBuffer = buffers[0];
+    if(!isAscii && firstBuffer.is_object() && !firstBuffer.contains("uri")) {
+        // Served at its exact size, TinyGLTF checks it
+        auto byteLength = firstBuffer.find("byteLength");
+        if(byteLength == firstBuffer.end() || !byteLength->is_number_unsigned() ||
+           byteLength->get<std::size_t>() > binaryChunk.size()) {
+            return {};
+        }
+        binaryChunk = binaryChunk.first(byteLength->get<std::size_t>());
+        firstBuffer["uri"] = GLB_BINARY_CHUNK_URI;
+    }
+    return json.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+// TinyGLTF file system callbacks serving the binary chunk given as user data, as
+// GLB_BINARY_CHUNK_URI. Other files are read from disk.
+bool isBinaryChunk(const std::string& path) {
+    return std::filesystem::path(path).filename() == GLB_BINARY_CHUNK_URI;
+}
+
+bool binaryChunkFileExists(const std::string& path, void*) {
+    return isBinaryChunk(path) || tinygltf::FileExists(path, nullptr);
+}
+
+std::string binaryChunkExpandFilePath(const std::string& path, void*) {
+    return isBinaryChunk(path) ? path : tinygltf::ExpandFilePath(path, nullptr);
+}
+
+bool binaryChunkReadWholeFile(std::vector<unsigned char>* out, std::string* err,
+                              const std::string& path, void* userData) {
+    if(!isBinaryChunk(path)) return tinygltf::ReadWholeFile(out, err, path, nullptr);
+
+    // Kept by TinyGLTF as the buffer's data, the one copy it makes of any GLB buffer
+    const auto& chunk = *static_cast<const std::span<const unsigned char>*>(userData);
+    out->assign(chunk.begin(), chunk.end());
+    return true;
+}
+
+bool binaryChunkGetFileSize(std::size_t* size, std::string* err, const std::string& path,
+                            void* userData) {
+    if(!isBinaryChunk(path)) {
+        return tinygltf::GetFileSizeInBytes(size, err, path, nullptr);
+    }
+
+    *size = static_cast<const std::span<const unsigned char>*>(userData)->size();
+    return true;
+}
+
+std::size_t getSize(const tinygltf::Value& object, const std::string& key) {
+    return static_cast<std::size_t>(object.Get(key).GetNumberAsDouble());
+}
+
+std::string getString(const tinygltf::Value& object, const std::string& key,
+                      const std::string& defaultValue) {
+    const tinygltf::Value& value = object.Get(key);
+    return value.IsString() ? value.Get<std::string>() : defaultValue;
+}
+
+// Normalized integers map to [0, 1] or [-1, 1], as in the glTF spec
+template <typename Target, typename Component>
+Target convertComponent(Component component, bool normalized) {
+    if constexpr(std::is_floating_point_v<Target> && std::is_integral_v<Component>) {
+        if(normalized) {
+            constexpr float MAX = std::numeric_limits<Component>::max();
+            return std::max(static_cast<float>(component) / MAX, -1.0f);
+        }
+    }
+    return static_cast<Target>(component);
+}
+
+// Decodes elements one stride apart straight into a member of the vertices
+template <typename Component, typename Vec>
+void streamComponents(const unsigned char* data, std::size_t stride, bool normalized,
+                      std::span<ObjResource::Vertex> vertices,
+                      Vec ObjResource::Vertex::*member) {
+    using Target = typename Vec::value_type;
+    for(ObjResource::Vertex& vertex : vertices) {
+        Vec& value = vertex.*member;
+        if constexpr(std::is_same_v<Component, Target>) {
+            std::memcpy(&value, data, sizeof(Vec));
+        } else {
+            for(int c = 0; c < Vec::length(); ++c) {
+                Component component;
+                std::memcpy(&component, data + c * sizeof(Component), sizeof(Component));
+                value[c] = convertComponent<Target>(component, normalized);
+            }
+        }
+        data += stride;
+    }
+}
+
+// Reads the attribute from its buffer view into the vertices, without intermediate
+// copies. False if the primitive doesn't have it or it can't be read.
+template <typename Vec>
+bool streamAttribute(const tinygltf::Model& model, const tinygltf::Primitive& primitive,
+                     const std::string& attribute,
+                     std::span<ObjResource::Vertex> vertices,
+                     Vec ObjResource::Vertex::*member) {
     auto it = primitive.attributes.find(attribute);
-    if(it == primitive.attributes.end()) return;
+    if(it == primitive.attributes.end()) return false;
 
     const tinygltf::Accessor& accessor = model.accessors[it->second];
+    if(accessor.count != vertices.size() || accessor.bufferView < 0 ||
+       tinygltf::GetNumComponentsInType(accessor.type) < Vec::length()) {
+        Log::warn() << "Cannot read glTF attribute " << attribute << ".";
+        return false;
+    }
+    if(vertices.empty()) return true;
+
     const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
     const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+    int stride = accessor.ByteStride(bufferView);
+    std::size_t offset = bufferView.byteOffset + accessor.byteOffset;
+    std::size_t elementSize =
+        tinygltf::GetComponentSizeInBytes(accessor.componentType) * Vec::length();
+    if(stride <= 0 ||
+       offset + stride * (vertices.size() - 1) + elementSize > buffer.data.size()) {
+        Log::warn() << "glTF attribute " << attribute << " is out of its buffer.";
+        return false;
+    }
 
-    const unsigned char* dataPtr =
-        buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
-    output.resize(accessor.count);
+    const unsigned char* data = buffer.data.data() + offset;
+    bool normalized = accessor.normalized;
+    switch(accessor.componentType) {
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:
+            streamComponents<float>(data, stride, normalized, vertices, member);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+            streamComponents<std::int8_t>(data, stride, normalized, vertices, member);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            streamComponents<std::uint8_t>(data, stride, normalized, vertices, member);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+            streamComponents<std::int16_t>(data, stride, normalized, vertices, member);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            streamComponents<std::uint16_t>(data, stride, normalized, vertices, member);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+            streamComponents<std::uint32_t>(data, stride, normalized, vertices, member);
+            break;
+        default:
+            Log::warn() << "Unsupported component type for glTF attribute " << attribute
+                        << ".";
+            return false;
+    }
+    return true;
+}
 
-    if constexpr(std::is_same<T, glm::vec3>::value) {
-        const glm::vec3* data = reinterpret_cast<const glm::vec3*>(dataPtr);
-        std::copy(data, data + accessor.count, output.begin());
-    } else if constexpr(std::is_same<T, glm::vec2>::value) {
-        const glm::vec2* data = reinterpret_cast<const glm::vec2*>(dataPtr);
-        std::copy(data, data + accessor.count, output.begin());
-    } else if constexpr(std::is_same<T, glm::uvec4>::value) {
-        if(accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
-            const uint8_t* data = reinterpret_cast<const uint8_t*>(dataPtr);
-            for(size_t i = 0; i < accessor.count; i++) {
-                output[i] = glm::uvec4(data[i * 4 + 0], data[i * 4 + 1], data[i * 4 + 2],
-                                       data[i * 4 + 3]);
-            }
-        } else if(accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-            const uint16_t* data = reinterpret_cast<const uint16_t*>(dataPtr);
-            for(size_t i = 0; i < accessor.count; i++) {
-                output[i] = glm::uvec4(data[i * 4 + 0], data[i * 4 + 1], data[i * 4 + 2],
-                                       data[i * 4 + 3]);
-            }
-        } else {
-            Log::debug() << "Unsupported component type for JOINTS_0.";
-        }
-    } else if constexpr(std::is_same<T, glm::vec4>::value) {
-        const glm::vec4* data = reinterpret_cast<const glm::vec4*>(dataPtr);
-        std::copy(data, data + accessor.count, output.begin());
+template <typename Index>
+void offsetIndices(const unsigned char* data, unsigned int firstVertex,
+                   std::vector<unsigned int>& output) {
+    for(std::size_t i = 0; i < output.size(); ++i) {
+        Index index;
+        std::memcpy(&index, data + i * sizeof(Index), sizeof(Index));
+        output[i] = index + firstVertex;
     }
 }
 
-void extractIndices(const tinygltf::Primitive& primitive, const tinygltf::Model& model,
-                    std::vector<unsigned int>& output) {
+// Offset to index into the vertices of the whole resource
+void readIndices(const tinygltf::Primitive& primitive, const tinygltf::Model& model,
+                 unsigned int firstVertex, std::vector<unsigned int>& output) {
     if(primitive.indices < 0) return;
 
     const tinygltf::Accessor& accessor = model.accessors[primitive.indices];
@@ -67,45 +265,136 @@ void extractIndices(const tinygltf::Primitive& primitive, const tinygltf::Model&
 
     const unsigned char* dataPtr =
         buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
+    output.resize(accessor.count);
 
     switch(accessor.componentType) {
-        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
-            const uint8_t* indices = reinterpret_cast<const uint8_t*>(dataPtr);
-            output.assign(indices, indices + accessor.count);
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            offsetIndices<std::uint8_t>(dataPtr, firstVertex, output);
             break;
-        }
-        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
-            const uint16_t* indices = reinterpret_cast<const uint16_t*>(dataPtr);
-            output.assign(indices, indices + accessor.count);
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            offsetIndices<std::uint16_t>(dataPtr, firstVertex, output);
             break;
-        }
-        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: {
-            const uint32_t* indices = reinterpret_cast<const uint32_t*>(dataPtr);
-            output.assign(indices, indices + accessor.count);
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+            offsetIndices<std::uint32_t>(dataPtr, firstVertex, output);
             break;
-        }
         default:
             Log::error() << "Unsupported index format.";
+            output.clear();
             break;
     }
 }
 
+// Keeps the encoded bytes, so images are decoded in parallel by the loader instead of
+// one after the other by TinyGLTF
+bool deferImageDecoding(tinygltf::Image* image, const int, std::string*, std::string*,
+                        int, int, const unsigned char* bytes, int size, void*) {
+    image->image.assign(bytes, bytes + size);
+    image->as_is = true; // Still encoded
+    return true;
+}
+
+// Defaults to repeat and trilinear filtering, also without a glTF sampler
+ObjSampler::Parameters getSamplerParameters(const tinygltf::Model& model,
+                                            const tinygltf::Texture& texture) {
+    ObjSampler::Parameters parameters;
+    if(texture.sampler >= 0) {
+        const tinygltf::Sampler& sampler = model.samplers[texture.sampler];
+        if(sampler.minFilter != -1) parameters.minFilter = sampler.minFilter;
+        if(sampler.magFilter != -1) parameters.magFilter = sampler.magFilter;
+        if(sampler.wrapS != -1) parameters.wrapS = sampler.wrapS;
+        if(sampler.wrapT != -1) parameters.wrapT = sampler.wrapT;
+    }
+    return parameters;
+}
+
+// Texture indices of the material, by ObjTextureArray slot
+std::array<int, ObjTextureArray::COUNT> getSlotTextures(
+    const tinygltf::Material& material) {
+    std::array<int, ObjTextureArray::COUNT> textures;
+    textures[ObjTextureArray::BaseColor] =
+        material.pbrMetallicRoughness.baseColorTexture.index;
+    textures[ObjTextureArray::Normal] = material.normalTexture.index;
+    textures[ObjTextureArray::MetallicRoughness] =
+        material.pbrMetallicRoughness.metallicRoughnessTexture.index;
+    return textures;
+}
+
+constexpr int ObjMaterial::*SLOT_ARRAYS[ObjTextureArray::COUNT] = {
+    &ObjMaterial::baseColorArray, &ObjMaterial::normalArray,
+    &ObjMaterial::metallicRoughnessArray};
+constexpr int ObjMaterial::*SLOT_LAYERS[ObjTextureArray::COUNT] = {
+    &ObjMaterial::baseColorLayer, &ObjMaterial::normalLayer,
+    &ObjMaterial::metallicRoughnessLayer};
+
+// Decodes the encoded bytes kept by deferImageDecoding() into RGBA8
+void decodeImage(tinygltf::Image& image) {
+    int width, height, components;
+    stbi_uc* pixels =
+        stbi_load_from_memory(image.image.data(), static_cast<int>(image.image.size()),
+                              &width, &height, &components, 4);
+    if(pixels) {
+        image.width = width;
+        image.height = height;
+        image.component = 4; // As requested, like TinyGLTF does
+        image.bits = 8;
+        image.image.assign(pixels, pixels + width * height * 4);
+        stbi_image_free(pixels);
+    } else {
+        Log::error() << "Failed to decode image '" << image.name
+                     << "': " << stbi_failure_reason();
+        image.image.clear();
+    }
+    image.as_is = false;
+}
+
 } // namespace
 
-GltfLoader::GltfLoader(const std::filesystem::path& path) : mPath(path) {
+GltfLoader::GltfLoader(const std::filesystem::path& path, AssetPack::CPtr pack)
+    : mPath(path), mPack(std::move(pack)),
+      mUseBakedTextures(TextureCompression::isSupported()) {
     Log::debug() << "Creating GltfLoader for '" << mPath.string() << "'.";
 }
 
-bool GltfLoader::load(ObjResource& resource) {
-    tinygltf::Model model;
+bool GltfLoader::parse() {
     tinygltf::TinyGLTF loader;
+    loader.SetImageLoader(deferImageDecoding, nullptr);
     std::string err, warn;
 
+    // External buffers and images are still looked up on disk, next to the path
+    ResourceFile file(mPath, mPack.get());
+    if(!file.isOpen()) {
+        Log::error() << "Failed to open '" << mPath.string() << "'!";
+        return false;
+    }
+    bool isAscii = mPath.extension() == ".gltf";
+    std::span<const unsigned char> data = file.getData();
+    std::span<const unsigned char> binaryChunk; // Of a GLB, read from the file as is
+    std::string patched = patchFallbackBuffers(data, isAscii, binaryChunk);
+    if(!patched.empty() && !isAscii) {
+        tinygltf::FsCallbacks callbacks{};
+        callbacks.FileExists = binaryChunkFileExists;
+        callbacks.ExpandFilePath = binaryChunkExpandFilePath;
+        callbacks.ReadWholeFile = binaryChunkReadWholeFile;
+        callbacks.WriteWholeFile = tinygltf::WriteWholeFile;
+        callbacks.GetFileSizeInBytes = binaryChunkGetFileSize;
+        callbacks.user_data = &binaryChunk;
+        loader.SetFsCallbacks(callbacks);
+    }
+
     bool ret;
-    if(mPath.extension() == ".obj") {
-        ret = loader.LoadASCIIFromFile(&model, &err, &warn, mPath.string());
+    std::string baseDir = mPath.parent_path().string();
+    if(!patched.empty()) {
+        ret = loader.LoadASCIIFromString(&mModel, &err, &warn, patched.data(),
+                                         static_cast<unsigned int>(patched.size()),
+                                         baseDir);
+    } else if(isAscii) {
+        ret = loader.LoadASCIIFromString(&mModel, &err, &warn,
+                                         reinterpret_cast<const char*>(data.data()),
+                                         static_cast<unsigned int>(data.size()), baseDir);
     } else {
-        ret = loader.LoadBinaryFromFile(&model, &err, &warn, mPath.string());
+        ret = loader.LoadBinaryFromMemory(&mModel, &err, &warn, data.data(),
+                                          static_cast<unsigned int>(data.size()),
+                                          baseDir);
     }
     if(!warn.empty()) {
         warn.pop_back(); // Remove trailing newline
@@ -114,26 +403,233 @@ bool GltfLoader::load(ObjResource& resource) {
     if(!ret && !err.empty()) {
         err.pop_back(); // Remove trailing newline
         Log::error() << "TinyGLTF error: " << err;
-        if(stbi_failure_reason()) {
-            Log::error() << "STB Image error: " << stbi_failure_reason();
-        }
         return false;
     }
+    decodeImages();
+
+    for(const std::string& extension : mModel.extensionsRequired) {
+        if(extension != MESHOPT_COMPRESSION && extension != MESH_QUANTIZATION) {
+            Log::warn() << "Unsupported required glTF extension " << extension << " in '"
+                        << mPath.string() << "'.";
+        }
+    }
+    if(!decodeCompressedBufferViews()) return false;
+
+    if(mModel.animations.size() > 0) {
+        mAnimationContainer = std::make_unique<AnimationContainer>(mModel);
+    }
+
+    parseMaterials();
+    parseMeshes();
+    return true;
+}
+
+bool GltfLoader::upload(ObjResource& resource) {
+    resource.animationContainer = mAnimationContainer;
+    loadImages(resource);
+    loadTextures(resource);
+    resource.materialUniformBuffer.setData(GL_UNIFORM_BUFFER, mMaterials);
+
+    for(ParsedMesh& parsedMesh : mMeshes) {
+        auto objMesh =
+            ObjMesh::create(resource, parsedMesh.name, std::move(parsedMesh.indices));
+        objMesh->transform = parsedMesh.transform;
+        objMesh->firstVertex = parsedMesh.firstVertex;
+        objMesh->vertexCount = parsedMesh.vertexCount;
+        objMesh->skin = parsedMesh.skin;
+        objMesh->animationNode = parsedMesh.animationNode;
+
+        resource.objMeshes.emplace_back(objMesh);
+        setMeshTextures(resource, objMesh, parsedMesh.material);
+    }
+    mMeshes.clear();
+
+    // Upload interleaved vertex data to GPU. Bounds are known, so no CPU copy is kept.
+    resource.vertexBuffer.setData(GL_ARRAY_BUFFER, mVertices);
+    resource.boundingBox = ObjBoundingBox::create(mMinCorner, mMaxCorner);
+    mVertices = {};
+
+    mModel = {}; // Decoded images were handed to the TextureStreamer
+    return true;
+}
+
+// Starts decoding every image on worker threads, for loadImages() to wait on. Loaders
+// already running on a pool thread decode them right away, instead of nesting pools.
+void GltfLoader::decodeImages() {
+    if(mModel.images.empty()) return;
+
+    mImageHashes.assign(mModel.images.size(), 0);
+    mBakedImages.assign(mModel.images.size(), nullptr);
+    if(Utils::ThreadPool::isWorkerThread()) {
+        for(std::size_t i = 0; i < mModel.images.size(); ++i) loadImageData(i);
+        return;
+    }
+
+    mImageDecoders = std::make_unique<Utils::ThreadPool>(
+        std::min<std::size_t>(mModel.images.size(), std::thread::hardware_concurrency()));
+    for(std::size_t i = 0; i < mModel.images.size(); ++i) {
+        mImageDecoders->submit([this, i]() { loadImageData(i); });
+    }
+}
+
+// Any thread
+void GltfLoader::loadImageData(std::size_t index) {
+    tinygltf::Image& image = mModel.images[index];
+    std::uint64_t& hash = mImageHashes[index];
+    if(image.as_is && !image.image.empty()) {
+        hash = Utils::hashBytes(image.image.data(), image.image.size());
+    }
+
+    // Images another resource already uses stay encoded, queueImage() and
+    // packTextures() share them
+    if(hash && !TextureCache::get().containsImage(hash)) decodeImageData(index);
+
+    std::lock_guard<std::mutex> lock(mDecodedImages.mutex);
+    mDecodedImages.indices.push(index);
+    mDecodedImages.imageDecoded.notify_one();
+}
+
+// Any thread. Baked textures replace the source image.
+void GltfLoader::decodeImageData(std::size_t index) {
+    tinygltf::Image& image = mModel.images[index];
+    std::uint64_t hash = mImageHashes[index];
+    auto baked = std::make_shared<TextureCompression::CompressedImage>();
+    if(mUseBakedTextures &&
+       TextureCompression::read(TextureCompression::getCachePath(hash), hash, *baked)) {
+        image.width = baked->width;
+        image.height = baked->height;
+        image.image.clear();
+        image.as_is = false;
+        mBakedImages[index] = std::move(baked);
+    } else {
+        decodeImage(image);
+    }
+}
+
+// Encodes the images of every glTF model in the dir which aren't baked yet
+bool GltfLoader::bakeTextures(const std::filesystem::path& resourceDir) {
+    bool success = true;
+    std::size_t bakedCount = 0;
+    std::error_code error;
+    for(const auto& entry :
+        std::filesystem::recursive_directory_iterator(resourceDir, error)) {
+        std::string extension = entry.path().extension().string();
+        if(extension != ".gltf" && extension != ".glb") continue;
+
+        GltfLoader loader(entry.path());
+        success &= loader.parse() && loader.bakeImages(bakedCount);
+    }
+
+    Log::info() << "Baked " << bakedCount << " textures into '"
+                << Constants::MESH_CACHE_DIR << "'.";
+    return success && !error;
+}
+
+bool GltfLoader::bakeImages(std::size_t& bakedCount) {
+    std::vector<bool> isNormalMap(mModel.images.size(), false);
+    for(const tinygltf::Material& material : mModel.materials) {
+        int texture = material.normalTexture.index;
+        if(texture < 0 || texture >= static_cast<int>(mModel.textures.size())) continue;
+        int source = mModel.textures[texture].source;
+        if(source >= 0 && source < static_cast<int>(isNormalMap.size())) {
+            isNormalMap[source] = true;
+        }
+    }
 
-    if(model.animations.size() > 0) {
-        resource.animationContainer = std::make_unique<AnimationContainer>(model);
+    bool success = true;
+    for(std::size_t baked = 0; baked < mModel.images.size(); ++baked) {
+        std::size_t index = waitForDecodedImage();
+        const tinygltf::Image& image = mModel.images[index];
+        std::filesystem::path path =
+            TextureCompression::getCachePath(mImageHashes[index]);
+        if(image.image.empty() || std::filesystem::exists(path)) continue;
+
+        TextureCompression::Format format = TextureCompression::chooseFormat(
+            image.image, image.component, isNormalMap[index]);
+        success &= TextureCompression::write(
+            path, mImageHashes[index],
+            TextureCompression::encode(image.image, image.width, image.height,
+                                       image.component, format));
+        ++bakedCount;
     }
+    mImageDecoders.reset();
+    return success;
+}
+
+// Decodes EXT_meshopt_compression buffer views into their fallback buffer, so the rest
+// of the loader reads them like any other buffer view
+bool GltfLoader::decodeCompressedBufferViews() {
+    std::size_t compressedSize = 0;
+    std::size_t decodedSize = 0;
+    for(std::size_t i = 0; i < mModel.bufferViews.size(); ++i) {
+        tinygltf::BufferView& bufferView = mModel.bufferViews[i];
+        auto extension = bufferView.extensions.find(MESHOPT_COMPRESSION);
+        if(extension == bufferView.extensions.end()) continue;
+
+        const tinygltf::Value& compression = extension->second;
+        int sourceIndex = compression.Get("buffer").GetNumberAsInt();
+        std::size_t sourceOffset = getSize(compression, "byteOffset");
+        std::size_t sourceLength = getSize(compression, "byteLength");
+        std::size_t stride = getSize(compression, "byteStride");
+        std::size_t count = getSize(compression, "count");
+        std::string mode = getString(compression, "mode", "");
+        std::string filter = getString(compression, "filter", "NONE");
+
+        int bufferCount = static_cast<int>(mModel.buffers.size());
+        if(sourceIndex < 0 || sourceIndex >= bufferCount || bufferView.buffer < 0 ||
+           bufferView.buffer >= bufferCount ||
+           sourceOffset + sourceLength > mModel.buffers[sourceIndex].data.size()) {
+            Log::error() << "Compressed buffer view " << i << " of '" << mPath.string()
+                         << "' is out of its buffer!";
+            return false;
+        }
 
-    loadImages(resource, model);
-    loadTextures(resource, model);
-    loadMaterials(resource, model);
-    loadMeshes(resource, model);
+        // Fallback buffers usually have no data
+        std::vector<unsigned char>& target = mModel.buffers[bufferView.buffer].data;
+        target.resize(std::max(target.size(), bufferView.byteOffset + count * stride));
+        unsigned char* destination = target.data() + bufferView.byteOffset;
+        const unsigned char* source =
+            mModel.buffers[sourceIndex].data.data() + sourceOffset;
+
+        int result = -1;
+        if(mode == "ATTRIBUTES") {
+            result = meshopt_decodeVertexBuffer(destination, count, stride, source,
+                                                sourceLength);
+        } else if(mode == "TRIANGLES") {
+            result = meshopt_decodeIndexBuffer(destination, count, stride, source,
+                                               sourceLength);
+        } else if(mode == "INDICES") {
+            result = meshopt_decodeIndexSequence(destination, count, stride, source,
+                                                 sourceLength);
+        }
+        if(result != 0) {
+            Log::error() << "Failed to decode compressed buffer view " << i << " of '"
+                         << mPath.string() << "' (mode " << mode << ")!";
+            return false;
+        }
+
+        if(filter == "OCTAHEDRAL") {
+            meshopt_decodeFilterOct(destination, count, stride);
+        } else if(filter == "QUATERNION") {
+            meshopt_decodeFilterQuat(destination, count, stride);
+        } else if(filter == "EXPONENTIAL") {
+            meshopt_decodeFilterExp(destination, count, stride);
+        }
+
+        compressedSize += sourceLength;
+        decodedSize += count * stride;
+        bufferView.extensions.erase(extension);
+    }
+
+    if(decodedSize > 0) {
+        Log::debug() << "Decoded " << compressedSize / 1024 << " KiB of compressed "
+                     << "buffer views into " << decodedSize / 1024 << " KiB.";
+    }
     return true;
 }
 
-void GltfLoader::loadMaterials(ObjResource& resource, const tinygltf::Model& model) {
-    std::vector<ObjMaterial> objMaterials;
-    for(const tinygltf::Material& gltfMaterial : model.materials) {
+void GltfLoader::parseMaterials() {
+    for(const tinygltf::Material& gltfMaterial : mModel.materials) {
         ObjMaterial material = {};
 
         // Base Color (GLTF stores it as RGBA)
@@ -166,111 +662,328 @@ void GltfLoader::loadMaterials(ObjResource& resource, const tinygltf::Model& mod
         material.sheen =
             0.0f; // Not supported in GLTF core, but could be added via extensions.
 
-        objMaterials.push_back(material);
+        mMaterials.push_back(material);
     }
+}
 
-    resource.materialUniformBuffer.setData(GL_UNIFORM_BUFFER, objMaterials);
+// Index of the next decoded image, in decoding order
+std::size_t GltfLoader::waitForDecodedImage() {
+    std::unique_lock<std::mutex> lock(mDecodedImages.mutex);
+    mDecodedImages.imageDecoded.wait(
+        lock, [this]() { return !mDecodedImages.indices.empty(); });
+    std::size_t index = mDecodedImages.indices.front();
+    mDecodedImages.indices.pop();
+    return index;
 }
 
-void GltfLoader::loadImages(ObjResource& resource, const tinygltf::Model& model) {
-    for(const tinygltf::Image& gltfImage : model.images) {
-        if(gltfImage.image.empty()) {
-            Log::warn() << "Empty image data for image '" << gltfImage.name << "'.";
-            resource.objImages.emplace_back(
-                ObjImage::create(gltfImage.name, 0, 0, 0)); // Empty image
-            continue;
+// Packs what it can into texture arrays once every image is decoded, and queues the
+// other images for upload
+void GltfLoader::loadImages(ObjResource& resource) {
+    if(mImageDecoders) mImageDecoders->wait();
+    mImageDecoders.reset();
+
+    std::vector<bool> isStreamed = packTextures(resource);
+    std::vector<ObjImage::Ptr> images(mModel.images.size());
+    for(std::size_t i = 0; i < images.size(); ++i) {
+        images[i] = isStreamed[i] ? queueImage(i)
+                                  : ObjImage::create(mModel.images[i].name, 0, 0, 0);
+    }
+
+    resource.objImages.insert(resource.objImages.end(), images.begin(), images.end());
+}
+
+// For each slot, packs the textures of the materials into one texture array per group
+// of images sharing their size, format and sampler, or shares the array of another
+// resource. Returns which images still need a texture of their own.
+std::vector<bool> GltfLoader::packTextures(ObjResource& resource) {
+    struct ImageFormat {
+        int width = 0;
+        int height = 0;
+        GLenum internalFormat = GL_NONE; // If it can't be packed
+    };
+    // Images left encoded are either layers of a cached array, or shared images which
+    // are never packed
+    auto getImageFormat = [this](int image) -> ImageFormat {
+        const tinygltf::Image& gltfImage = mModel.images[image];
+        if(mBakedImages[image]) {
+            return {gltfImage.width, gltfImage.height,
+                    TextureCompression::getInternalFormat(mBakedImages[image]->format)};
+        }
+        if(gltfImage.as_is) {
+            ObjTextureArray::Ptr array =
+                TextureCache::get().findLayerArray(mImageHashes[image]);
+            if(!array) return {};
+            return {array->width, array->height, array->internalFormat};
         }
+        if(gltfImage.image.empty() || gltfImage.component != 4) return {};
+        return {gltfImage.width, gltfImage.height, GL_RGBA8};
+    };
+    auto getImage = [this](int texture) {
+        if(texture < 0 || texture >= static_cast<int>(mModel.textures.size())) return -1;
+        int image = mModel.textures[texture].source;
+        return image < static_cast<int>(mModel.images.size()) ? image : -1;
+    };
 
-        // Generate GL texture
-        GLuint texId;
-        glGenTextures(1, &texId);
-        glBindTexture(GL_TEXTURE_2D, texId);
+    struct TextureGroup {
+        int slot;
+        ImageFormat format;
+        ObjSampler::Parameters sampler;
+        std::vector<int> images; // Distinct, in layer order
+        ObjTextureArray::Ptr array;
+        int arrayIndex = -1; // In the resource, if packed
+    };
+    std::vector<TextureGroup> groups;
+    auto findGroup = [&groups](int slot, int image, std::uint64_t samplerKey) {
+        return std::find_if(groups.begin(), groups.end(), [&](const TextureGroup& group) {
+            return group.slot == slot && group.sampler.getKey() == samplerKey &&
+                   std::find(group.images.begin(), group.images.end(), image) !=
+                       group.images.end();
+        });
+    };
+    auto groupTextures = [&]() {
+        groups.clear();
+        for(const tinygltf::Material& material : mModel.materials) {
+            std::array<int, ObjTextureArray::COUNT> textures = getSlotTextures(material);
+            for(int slot = 0; slot < ObjTextureArray::COUNT; ++slot) {
+                int image = getImage(textures[slot]);
+                if(image < 0) continue;
+                ImageFormat format = getImageFormat(image);
+                if(format.internalFormat == GL_NONE) continue;
+
+                ObjSampler::Parameters sampler =
+                    getSamplerParameters(mModel, mModel.textures[textures[slot]]);
+                if(findGroup(slot, image, sampler.getKey()) != groups.end()) continue;
+                auto group = std::find_if(groups.begin(), groups.end(), [&](auto& other) {
+                    return other.slot == slot && other.format.width == format.width &&
+                           other.format.height == format.height &&
+                           other.format.internalFormat == format.internalFormat &&
+                           other.sampler.getKey() == sampler.getKey() &&
+                           static_cast<int>(other.images.size()) <
+                               Constants::TEXTURE_ARRAY_MAX_LAYERS;
+                });
+                if(group == groups.end()) {
+                    groups.push_back({slot, format, sampler, {}, nullptr, -1});
+                    group = groups.end() - 1;
+                }
+                group->images.push_back(image);
+            }
+        }
+    };
+    // Single images gain nothing from a texture array
+    auto isPacked = [](const TextureGroup& group) { return group.images.size() >= 2; };
+    auto getArrayKey = [this](const TextureGroup& group) {
+        std::vector<std::uint64_t> layerHashes;
+        for(int image : group.images) layerHashes.push_back(mImageHashes[image]);
+        return TextureCache::getTextureArrayKey(layerHashes, group.sampler.getKey());
+    };
 
-        // Load image data
-        Log::debug() << "Loading image '" << gltfImage.name << "' with dimensions "
-                     << gltfImage.width << "x" << gltfImage.height << " and "
-                     << gltfImage.component << " components.";
+    // Arrays other resources have are shared as is. Layers of theirs which end up in a
+    // new array are decoded, then grouped again by their decoded format.
+    groupTextures();
+    bool isDecoding = false;
+    for(TextureGroup& group : groups) {
+        if(!isPacked(group)) continue;
+        std::uint64_t key = getArrayKey(group);
+        group.array = key ? TextureCache::get().findTextureArray(key) : nullptr;
+        if(group.array) continue;
+        for(int image : group.images) {
+            if(!mModel.images[image].as_is) continue;
+            decodeImageData(image);
+            isDecoding = true;
+        }
+    }
+    if(isDecoding) {
+        groupTextures();
+        for(TextureGroup& group : groups) {
+            std::uint64_t key = isPacked(group) ? getArrayKey(group) : 0;
+            group.array = key ? TextureCache::get().findTextureArray(key) : nullptr;
+        }
+    }
 
-        GLenum format = (gltfImage.component == 3) ? GL_RGB : GL_RGBA;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, gltfImage.width, gltfImage.height, 0,
-                     format, GL_UNSIGNED_BYTE, gltfImage.image.data());
+    std::vector<bool> isStreamed(mModel.images.size(), true);
+    std::vector<int> packedUses(mModel.images.size(), 0);
+    for(const TextureGroup& group : groups) {
+        if(!isPacked(group)) continue;
+        for(int image : group.images) {
+            isStreamed[image] = false;
+            if(!group.array) ++packedUses[image];
+        }
+    }
+    // Images also used unpacked keep their texture, emissive ones included
+    for(const tinygltf::Material& material : mModel.materials) {
+        std::array<int, ObjTextureArray::COUNT> textures = getSlotTextures(material);
+        for(int slot = 0; slot < ObjTextureArray::COUNT; ++slot) {
+            int image = getImage(textures[slot]);
+            if(image < 0) continue;
+            std::uint64_t samplerKey =
+                getSamplerParameters(mModel, mModel.textures[textures[slot]]).getKey();
+            auto group = findGroup(slot, image, samplerKey);
+            if(group == groups.end() || !isPacked(*group)) isStreamed[image] = true;
+        }
+        int emissive = getImage(material.emissiveTexture.index);
+        if(emissive >= 0) isStreamed[emissive] = true;
+    }
 
-        glGenerateMipmap(GL_TEXTURE_2D);
+    for(TextureGroup& group : groups) {
+        if(!isPacked(group)) continue;
+        if(group.array) {
+            Log::debug() << "Sharing a texture array of " << group.images.size()
+                         << " images.";
+        } else {
+            group.array = ObjTextureArray::create(
+                group.format.width, group.format.height,
+                static_cast<int>(group.images.size()), group.format.internalFormat,
+                TextureCache::get().getSampler(group.sampler));
+            for(int layer = 0; layer < group.array->layerCount; ++layer) {
+                int image = group.images[layer];
+                std::vector<unsigned char>& pixels = mModel.images[image].image;
+                if(mBakedImages[image]) {
+                    TextureUploader::get().queue(group.array, layer, mBakedImages[image]);
+                } else if(--packedUses[image] > 0 || isStreamed[image]) {
+                    // Still needed
+                    TextureUploader::get().queue(group.array, layer, pixels);
+                } else {
+                    TextureUploader::get().queue(group.array, layer, std::move(pixels));
+                }
+            }
 
-        GLenum error = glGetError();
-        if(error != GL_NO_ERROR) {
-            Log::error() << "OpenGL error: " << error;
+            std::uint64_t key = getArrayKey(group);
+            if(key) {
+                std::vector<std::uint64_t> layerHashes;
+                for(int image : group.images) layerHashes.push_back(mImageHashes[image]);
+                TextureCache::get().addTextureArray(key, group.array, layerHashes);
+            }
+            Log::debug() << "Packed " << group.images.size() << " images of "
+                         << group.format.width << "x" << group.format.height
+                         << " into a texture array.";
         }
+        group.arrayIndex = static_cast<int>(resource.objTextureArrays.size());
+        resource.objTextureArrays.push_back(group.array);
+    }
+
+    for(std::size_t i = 0; i < mModel.materials.size(); ++i) {
+        std::array<int, ObjTextureArray::COUNT> textures =
+            getSlotTextures(mModel.materials[i]);
+        for(int slot = 0; slot < ObjTextureArray::COUNT; ++slot) {
+            int image = getImage(textures[slot]);
+            if(image < 0) continue;
+            std::uint64_t samplerKey =
+                getSamplerParameters(mModel, mModel.textures[textures[slot]]).getKey();
+            auto group = findGroup(slot, image, samplerKey);
+            if(group == groups.end() || !isPacked(*group)) continue;
+            auto layer = std::find(group->images.begin(), group->images.end(), image);
+            mMaterials[i].*SLOT_ARRAYS[slot] = group->arrayIndex;
+            mMaterials[i].*SLOT_LAYERS[slot] =
+                static_cast<int>(layer - group->images.begin());
+        }
+    }
+    return isStreamed;
+}
+
+// Shares the image if another resource has it
+ObjImage::Ptr GltfLoader::queueImage(std::size_t index) {
+    tinygltf::Image& gltfImage = mModel.images[index];
+    std::uint64_t hash = mImageHashes[index];
+    if(ObjImage::Ptr shared = hash ? TextureCache::get().findImage(hash) : nullptr) {
+        Log::debug() << "Sharing image '" << shared->name << "' for image '"
+                     << gltfImage.name << "'.";
+        return shared;
+    }
+    if(hash && gltfImage.as_is) {
+        decodeImageData(index); // Its last user was unloaded since, or it was packed
+    }
+
+    ObjImage::Ptr objImage = createImage(index);
+    if(hash && objImage->width > 0) TextureCache::get().addImage(hash, objImage);
+    return objImage;
+}
 
-        // Create ObjImage
+ObjImage::Ptr GltfLoader::createImage(std::size_t index) {
+    tinygltf::Image& gltfImage = mModel.images[index];
+    if(mBakedImages[index]) {
+        Log::debug() << "Loading baked image '" << gltfImage.name << "' with dimensions "
+                     << gltfImage.width << "x" << gltfImage.height << ".";
         auto objImage =
-            ObjImage::create(gltfImage.name, texId, gltfImage.width, gltfImage.height);
-        resource.objImages.emplace_back(objImage);
+            ObjImage::create(gltfImage.name, 0, gltfImage.width, gltfImage.height);
+        TextureStreamer::get().add(objImage, std::move(mBakedImages[index]));
+        return objImage;
+    }
+    if(gltfImage.image.empty()) {
+        Log::warn() << "Empty image data for image '" << gltfImage.name << "'.";
+        return ObjImage::create(gltfImage.name, 0, 0, 0); // Empty image
     }
+
+    Log::debug() << "Loading image '" << gltfImage.name << "' with dimensions "
+                 << gltfImage.width << "x" << gltfImage.height << " and "
+                 << gltfImage.component << " components.";
+
+    // The texture is created by the streamer, over the next frames
+    auto objImage =
+        ObjImage::create(gltfImage.name, 0, gltfImage.width, gltfImage.height);
+    TextureStreamer::get().add(objImage, std::move(gltfImage.image),
+                               gltfImage.component);
+    return objImage;
 }
 
-void GltfLoader::loadTextures(ObjResource& resource, const tinygltf::Model& model) {
+void GltfLoader::loadTextures(ObjResource& resource) {
     auto emptyImage = ObjImage::create("empty_image", 0, 0, 0);
 
-    for(const tinygltf::Texture& gltfTexture : model.textures) {
+    for(const tinygltf::Texture& gltfTexture : mModel.textures) {
         if(gltfTexture.source < 0) {
             Log::warn() << "Texture '" << gltfTexture.name << "' has no image source.";
-            resource.objTextures.emplace_back(
-                ObjTexture::create(gltfTexture.name, emptyImage, 0)); // Empty texture
+            resource.objTextures.emplace_back( // Empty texture
+                ObjTexture::create(gltfTexture.name, emptyImage, nullptr));
             continue;
         }
 
         if(gltfTexture.source >= static_cast<int>(resource.objImages.size())) {
             Log::warn() << "Texture '" << gltfTexture.name
                         << "' has an invalid image source.";
-            resource.objTextures.emplace_back(
-                ObjTexture::create(gltfTexture.name, emptyImage, 0)); // Empty texture
+            resource.objTextures.emplace_back( // Empty texture
+                ObjTexture::create(gltfTexture.name, emptyImage, nullptr));
             continue;
         }
 
-        const tinygltf::Sampler& sampler = model.samplers[gltfTexture.sampler];
-
-        // Create GL sampler
-        GLuint samplerId;
-        glGenSamplers(1, &samplerId);
-
-        GLenum minFilter =
-            sampler.minFilter != -1 ? sampler.minFilter : GL_LINEAR_MIPMAP_LINEAR;
-        GLenum magFilter = sampler.magFilter != -1 ? sampler.magFilter : GL_LINEAR;
-        GLenum wrapS = sampler.wrapS != -1 ? sampler.wrapS : GL_REPEAT;
-        GLenum wrapT = sampler.wrapT != -1 ? sampler.wrapT : GL_REPEAT;
-
-        glSamplerParameteri(samplerId, GL_TEXTURE_MIN_FILTER, minFilter);
-        glSamplerParameteri(samplerId, GL_TEXTURE_MAG_FILTER, magFilter);
-        glSamplerParameteri(samplerId, GL_TEXTURE_WRAP_S, wrapS);
-        glSamplerParameteri(samplerId, GL_TEXTURE_WRAP_T, wrapT);
-
-        // Create ObjTexture
+        // Samplers are shared by every texture with the same parameters
         auto objTexture = ObjTexture::create(
-            gltfTexture.name, resource.objImages[gltfTexture.source], samplerId);
+            gltfTexture.name, resource.objImages[gltfTexture.source],
+            TextureCache::get().getSampler(getSamplerParameters(mModel, gltfTexture)));
         resource.objTextures.emplace_back(objTexture);
     }
 }
 
-void GltfLoader::loadMeshes(ObjResource& resource, const tinygltf::Model& model) {
+void GltfLoader::parseMeshes() {
     struct StackEntry {
         int nodeIndex = 0;
         int skin = -1;
         glm::mat4 transform = glm::mat4(1.0f);
     };
 
-    std::vector<ObjResource::Vertex> outVertices;
+    // Preallocated from the accessor counts, since vertices are decoded in place
+    std::size_t vertexCount = 0;
+    for(const tinygltf::Node& node : mModel.nodes) {
+        if(node.mesh < 0) continue;
+        for(const tinygltf::Primitive& primitive : mModel.meshes[node.mesh].primitives) {
+            auto it = primitive.attributes.find("POSITION");
+            if(it != primitive.attributes.end()) {
+                vertexCount += mModel.accessors[it->second].count;
+            }
+        }
+    }
+    mVertices.reserve(vertexCount);
+    mMinCorner = glm::vec3(std::numeric_limits<float>::max());
+    mMaxCorner = glm::vec3(std::numeric_limits<float>::lowest());
 
     // Traverse scene graph to apply transforms in the correct order
     std::stack<StackEntry> nodeStack;
 
-    if(model.scenes.size() > 1) {
+    if(mModel.scenes.size() > 1) {
         Log::warn() << "GLTF file has multiple scenes. Only the first will be loaded.";
     }
 
     // Push all root nodes with identity transform
-    for(int rootNodeIndex : model.scenes[0].nodes) {
-        nodeStack.push({rootNodeIndex, model.nodes[rootNodeIndex].skin});
+    for(int rootNodeIndex : mModel.scenes[0].nodes) {
+        nodeStack.push({rootNodeIndex, mModel.nodes[rootNodeIndex].skin});
     }
 
     while(!nodeStack.empty()) {
@@ -279,7 +992,7 @@ void GltfLoader::loadMeshes(ObjResource& resource, const tinygltf::Model& model)
         glm::mat4 transform = nodeStack.top().transform;
         nodeStack.pop();
 
-        const tinygltf::Node& node = model.nodes[nodeIndex];
+        const tinygltf::Node& node = mModel.nodes[nodeIndex];
         if(node.skin >= 0) {
             currentSkin = node.skin;
         }
@@ -304,7 +1017,7 @@ void GltfLoader::loadMeshes(ObjResource& resource, const tinygltf::Model& model)
         transform = transform * localTransform;
 
         if(node.mesh >= 0) {
-            loadPrimitives(resource, outVertices, model, nodeIndex, currentSkin, transform);
+            parsePrimitives(nodeIndex, currentSkin, transform);
         }
 
         for(int childIndex : node.children) {
@@ -313,27 +1026,26 @@ void GltfLoader::loadMeshes(ObjResource& resource, const tinygltf::Model& model)
         }
     }
 
-    // Upload interleaved vertex data to GPU
-    resource.vertexBuffer.setData(GL_ARRAY_BUFFER, outVertices);
-    resource.vertices = std::move(outVertices);
+    if(mVertices.empty()) {
+        Log::error() << "No points to calculate bounding box.";
+        mMinCorner = mMaxCorner = glm::vec3(0.0f);
+    }
 }
 
 // Each glTF primitive will generate an ObjMesh
-void GltfLoader::loadPrimitives(ObjResource& resource,
-                                std::vector<ObjResource::Vertex>& outVertices,
-                                const tinygltf::Model& model, int gltfNodeIndex,
-                                int gltfSkinIndex, const glm::mat4& meshTransform) {
-    const tinygltf::Node& node = model.nodes[gltfNodeIndex];
+void GltfLoader::parsePrimitives(int gltfNodeIndex, int gltfSkinIndex,
+                                 const glm::mat4& meshTransform) {
+    const tinygltf::Node& node = mModel.nodes[gltfNodeIndex];
     if(node.mesh < 0) {
         Log::warn() << "Node " << gltfNodeIndex << " has no mesh.";
         return;
     }
-    const tinygltf::Mesh& mesh = model.meshes[node.mesh];
+    const tinygltf::Mesh& mesh = mModel.meshes[node.mesh];
 
     // Get animation node if mesh is animated
-    AnimationNode* animationNode = nullptr;
-    if(resource.animationContainer) {
-        animationNode = resource.animationContainer->getNode(gltfNodeIndex);
+    int animationNode = -1;
+    if(mAnimationContainer) {
+        animationNode = mAnimationContainer->getNodeIndex(gltfNodeIndex);
         Log::debug() << "Loading animated mesh '" << mesh.name << "' with "
                      << mesh.primitives.size() << " primitive(s).";
     } else {
@@ -342,11 +1054,11 @@ void GltfLoader::loadPrimitives(ObjResource& resource,
     }
 
     // Get skin if present
-    Skin::Ptr skin = nullptr;
-    if(resource.animationContainer && gltfSkinIndex >= 0) {
+    Skin::CPtr skin = nullptr;
+    if(mAnimationContainer && gltfSkinIndex >= 0) {
         Log::debug() << "Fetching skin " << gltfSkinIndex << " for mesh '" << mesh.name
                      << "'.";
-        skin = resource.animationContainer->getSkin(gltfSkinIndex);
+        skin = mAnimationContainer->getSkin(gltfSkinIndex);
         if(!skin) {
             Log::warn() << "Failed to find skin with index " << gltfSkinIndex
                         << " for mesh '" << mesh.name << "'.";
@@ -361,67 +1073,55 @@ void GltfLoader::loadPrimitives(ObjResource& resource,
             continue;
         }
 
-        size_t baseIndex = outVertices.size(); // Offset for this mesh's indices
-
-        // Extract vertex attributes
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec3> normals;
-        std::vector<glm::vec2> texcoords;
-        std::vector<glm::uvec4> joints;
-        std::vector<glm::vec4> weights;
-
-        extractAttribute(primitive, model, "POSITION", positions);
-        extractAttribute(primitive, model, "NORMAL", normals);
-        extractAttribute(primitive, model, "TEXCOORD_0", texcoords);
-        extractAttribute(primitive, model, "JOINTS_0", joints);
-        extractAttribute(primitive, model, "WEIGHTS_0", weights);
-
-        if(normals.size() != positions.size() || texcoords.size() != positions.size()) {
-            Log::warn() << "GLTF primitive has inconsistent attribute sizes.";
-            return;
+        auto position = primitive.attributes.find("POSITION");
+        if(position == primitive.attributes.end()) {
+            Log::warn() << "Skipping primitive without positions.";
+            continue;
         }
+        size_t baseIndex = mVertices.size(); // Offset for this mesh's indices
+        size_t vertexCount = mModel.accessors[position->second].count;
 
         // Get material ID (GLTF assigns materials per primitive)
-        unsigned int materialId = (primitive.material >= 0) ? primitive.material : 0;
-
-        // Resize vectors to make sure they have the same size
-        size_t vertexCount = positions.size();
-        normals.resize(vertexCount, glm::vec3(0.0f));   // Default normal if missing
-        texcoords.resize(vertexCount, glm::vec2(0.0f)); // Default texcoord if missing
-        joints.resize(vertexCount, glm::uvec4(0));      // Default joints if missing
-        weights.resize(vertexCount, glm::vec4(0.0f));   // Default weights if missing
+        ObjResource::Vertex defaultVertex{};
+        defaultVertex.materialId = (primitive.material >= 0) ? primitive.material : 0;
+
+        // Decode attributes in place, missing ones stay zero
+        mVertices.resize(baseIndex + vertexCount, defaultVertex);
+        using Vertex = ObjResource::Vertex;
+        std::span<Vertex> vertices(mVertices.data() + baseIndex, vertexCount);
+        streamAttribute(mModel, primitive, "POSITION", vertices, &Vertex::position);
+        bool hasNormals =
+            streamAttribute(mModel, primitive, "NORMAL", vertices, &Vertex::normal);
+        bool hasTexcoords =
+            streamAttribute(mModel, primitive, "TEXCOORD_0", vertices, &Vertex::texcoord);
+        streamAttribute(mModel, primitive, "JOINTS_0", vertices, &Vertex::joints);
+        streamAttribute(mModel, primitive, "WEIGHTS_0", vertices, &Vertex::weights);
+        if(!hasNormals || !hasTexcoords) {
+            Log::warn() << "GLTF primitive is missing normals or texcoords.";
+        }
 
-        // Create interleaved vertex buffer
-        outVertices.reserve(outVertices.size() + vertexCount);
-        for(size_t i = 0; i < vertexCount; i++) {
-            outVertices.emplace_back(positions[i], normals[i], texcoords[i], materialId,
-                                     joints[i], weights[i]);
+        for(const Vertex& vertex : vertices) {
+            glm::vec3 point = glm::vec3(meshTransform * glm::vec4(vertex.position, 1.0f));
+            mMinCorner = glm::min(mMinCorner, point);
+            mMaxCorner = glm::max(mMaxCorner, point);
         }
 
         // Extract index buffer
         std::vector<unsigned int> primitiveIndices;
-        extractIndices(primitive, model, primitiveIndices);
-
-        // Adjust indices to match the current vertex offset
-        for(unsigned int& index : primitiveIndices) {
-            index += baseIndex;
-        }
-
-        // Store index buffer in ObjMesh
-        auto objMesh = ObjMesh::create(resource, mesh.name + "_p" + std::to_string(i),
-                                       std::move(primitiveIndices));
-        objMesh->transform = meshTransform;
-        objMesh->skin = skin;
-        objMesh->animationNode = animationNode;
-
-        resource.objMeshes.emplace_back(objMesh);
-        setMeshTextures(resource, objMesh, model, primitive);
+        readIndices(primitive, mModel, static_cast<unsigned int>(baseIndex),
+                    primitiveIndices);
+
+        // Index buffer will be stored in an ObjMesh on upload
+        mMeshes.push_back({mesh.name + "_p" + std::to_string(i),
+                           std::move(primitiveIndices), meshTransform,
+                           static_cast<unsigned int>(baseIndex),
+                           static_cast<unsigned int>(vertexCount), skin, animationNode,
+                           primitive.material});
     }
 }
 
 void GltfLoader::setMeshTextures(ObjResource& resource, ObjMesh::Ptr mesh,
-                                 const tinygltf::Model& model,
-                                 const tinygltf::Primitive& primitive) {
+                                 int materialIndex) {
     auto getTexture = [&resource](const tinygltf::TextureInfo& texInfo,
                                   const std::string& type) -> ObjTexture::Ptr {
         if(texInfo.texCoord > 0) {
@@ -447,17 +1147,31 @@ void GltfLoader::setMeshTextures(ObjResource& resource, ObjMesh::Ptr mesh,
         return resource.objTextures[texInfo.index];
     };
 
-    if(primitive.material < 0) {
+    if(materialIndex < 0) {
         Log::debug() << "Primitive has no material.";
         return;
     }
 
-    const tinygltf::Material& gltfMaterial = model.materials[primitive.material];
-    mesh->baseColorTexture =
-        getTexture(gltfMaterial.pbrMetallicRoughness.baseColorTexture, "base color");
-    mesh->normalTexture = getNormalTexture(gltfMaterial.normalTexture);
-    mesh->metallicRoughnessTexture = getTexture(
-        gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture, "metallic roughness");
+    // Packed textures are sampled through the material instead
+    const tinygltf::Material& gltfMaterial = mModel.materials[materialIndex];
+    const ObjMaterial& material = mMaterials[materialIndex];
+    for(int slot = 0; slot < ObjTextureArray::COUNT; ++slot) {
+        int array = material.*SLOT_ARRAYS[slot];
+        if(array >= 0) mesh->textureArrays[slot] = resource.objTextureArrays[array];
+    }
+    const auto& arrays = mesh->textureArrays;
+    if(!arrays[ObjTextureArray::BaseColor]) {
+        mesh->baseColorTexture =
+            getTexture(gltfMaterial.pbrMetallicRoughness.baseColorTexture, "base color");
+    }
+    if(!arrays[ObjTextureArray::Normal]) {
+        mesh->normalTexture = getNormalTexture(gltfMaterial.normalTexture);
+    }
+    if(!arrays[ObjTextureArray::MetallicRoughness]) {
+        mesh->metallicRoughnessTexture =
+            getTexture(gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture,
+                       "metallic roughness");
+    }
     mesh->emissiveTexture = getTexture(gltfMaterial.emissiveTexture, "emissive");
     mesh->normalScale = static_cast<float>(gltfMaterial.normalTexture.scale);
 }
\ No newline at end of file
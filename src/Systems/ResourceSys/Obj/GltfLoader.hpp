@@ -2,30 +2,86 @@
 
 #include <tiny_gltf.h>
 
+#include <condition_variable>
+#include <cstdint>
 #include <filesystem>
 #include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
 #include <vector>
 
 #include "ObjLoader.hpp"
+#include "ObjMaterial.hpp"
 #include "ObjResource.hpp"
+#include "TextureCompression.hpp"
+#include "Systems/ResourceSys/AssetPack.hpp"
+#include "Utils/ThreadPool.hpp"
 
 class GltfLoader : public ObjLoader {
 public:
-    GltfLoader(const std::filesystem::path& path);
-    bool load(ObjResource& resource) override final;
+    // Reads from the pack if given
+    GltfLoader(const std::filesystem::path& path, AssetPack::CPtr pack = nullptr);
+    bool parse() override final;
+    bool upload(ObjResource& resource) override final;
+
+    // Offline step, for TextureCompression
+    static bool bakeTextures(const std::filesystem::path& resourceDir);
 
 private:
+    // One per glTF primitive
+    struct ParsedMesh {
+        std::string name;
+        std::vector<unsigned int> indices;
+        glm::mat4 transform;
+        unsigned int firstVertex;
+        unsigned int vertexCount;
+        Skin::CPtr skin;
+        int animationNode;
+        int material;
+    };
+
+    // Indices of the images decoded so far, in completion order
+    struct DecodedImages {
+        std::mutex mutex;
+        std::condition_variable imageDecoded;
+        std::queue<std::size_t> indices;
+    };
+
     const std::filesystem::path mPath;
+    AssetPack::CPtr mPack;
+
+    // Parsed data, waiting for upload. Images are decoded in the model, on
+    // mImageDecoders while the rest is parsed (inline when already on a pool thread).
+    tinygltf::Model mModel;
+    AnimationContainer::Ptr mAnimationContainer;
+    std::vector<ObjResource::Vertex> mVertices;
+    std::vector<ParsedMesh> mMeshes;
+    std::vector<ObjMaterial> mMaterials;
+    glm::vec3 mMinCorner{}; // Of the vertices, with mesh transforms
+    glm::vec3 mMaxCorner{};
+    DecodedImages mDecodedImages;
+    const bool mUseBakedTextures;
+    std::vector<std::uint64_t> mImageHashes; // Of the encoded images
+    std::vector<std::shared_ptr<TextureCompression::CompressedImage>> mBakedImages;
+    std::unique_ptr<Utils::ThreadPool> mImageDecoders; // Last, as its jobs use the rest
+
+    void decodeImages();
+    void loadImageData(std::size_t index);
+    void decodeImageData(std::size_t index);
+    std::size_t waitForDecodedImage();
+    bool bakeImages(std::size_t& bakedCount);
 
-    void loadMaterials(ObjResource& resource, const tinygltf::Model& model);
-    void loadImages(ObjResource& resource, const tinygltf::Model& model);
-    void loadTextures(ObjResource& resource, const tinygltf::Model& model);
-    void loadMeshes(ObjResource& resource, const tinygltf::Model& model);
-    void loadPrimitives(ObjResource& resource,
-                        std::vector<ObjResource::Vertex>& outVertices,
-                        const tinygltf::Model& model, int gltfNodeIndex,
-                        int gltfSkinIndex, const glm::mat4& meshTransform);
-    void setMeshTextures(ObjResource& resource, ObjMesh::Ptr mesh,
-                         const tinygltf::Model& model,
-                         const tinygltf::Primitive& primitive);
+    bool decodeCompressedBufferViews();
+    void parseMaterials();
+    void parseMeshes();
+    void parsePrimitives(int gltfNodeIndex, int gltfSkinIndex,
+                         const glm::mat4& meshTransform);
+    void loadImages(ObjResource& resource);
+    std::vector<bool> packTextures(ObjResource& resource);
+    ObjImage::Ptr queueImage(std::size_t index);
+    ObjImage::Ptr createImage(std::size_t index);
+    void loadTextures(ObjResource& resource);
+    void setMeshTextures(ObjResource& resource, ObjMesh::Ptr mesh, int materialIndex);
 };
@@ -0,0 +1,224 @@
+#include "MeshCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "Constants.hpp"
+#include "Log.hpp"
+#include "Utils/FileUtils.hpp"
+#include "Utils/HashUtils.hpp"
+#include "Utils/MappedFile.hpp"
+
+namespace MeshCache {
+namespace {
+constexpr char MAGIC[4] = {'V', 'M', 'S', 'H'};
+constexpr std::uint32_t VERSION = 5; // Bump on any layout or parsing change
+
+// Followed by vertices, materials, mesh entries, indices and names
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t sourceHash;
+    std::uint32_t vertexSize; // Catches changes to ObjResource::Vertex
+    std::uint32_t vertexCount;
+    std::uint32_t materialCount;
+    std::uint32_t meshCount;
+    std::uint32_t indexCount;
+    std::uint32_t nameSize;
+    glm::vec3 minCorner;
+    glm::vec3 maxCorner;
+};
+
+struct MeshEntry {
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+};
+
+// Copies count elements at offset, advancing it. False if past the end of the file.
+template <typename T>
+bool readArray(const Utils::MappedFile& file, std::size_t& offset, std::size_t count,
+               T* out) {
+    std::size_t size = count * sizeof(T);
+    if(offset + size > file.getSize()) return false;
+
+    if(size > 0) std::memcpy(out, file.getData() + offset, size);
+    offset += size;
+    return true;
+}
+
+// Points at count elements at offset, in place, advancing it. False if past the end
+// of the file, or misaligned.
+template <typename T>
+bool viewArray(const Utils::MappedFile& file, std::size_t& offset, std::size_t count,
+               std::span<const T>& out) {
+    std::size_t size = count * sizeof(T);
+    const unsigned char* data = file.getData() + offset;
+    if(offset + size > file.getSize() ||
+       reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0) {
+        return false;
+    }
+
+    out = {reinterpret_cast<const T*>(data), count};
+    offset += size;
+    return true;
+}
+
+template <typename T>
+void writeArray(std::ofstream& file, const T* data, std::size_t count) {
+    file.write(reinterpret_cast<const char*>(data),
+               static_cast<std::streamsize>(count * sizeof(T)));
+}
+} // namespace
+
+std::vector<std::filesystem::path> findMaterialLibraries(
+    const std::filesystem::path& objPath, std::string_view objText) {
+    constexpr std::string_view KEYWORD = "mtllib";
+    constexpr std::string_view SPACES = " \t\r";
+    std::vector<std::filesystem::path> libraries;
+
+    // Scans the text in place, only looking at line starts
+    std::size_t lineStart = 0;
+    while(lineStart < objText.size()) {
+        std::size_t lineEnd = std::min(objText.find('\n', lineStart), objText.size());
+        std::string_view line = objText.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        if(!line.starts_with(KEYWORD)) continue;
+
+        line.remove_prefix(KEYWORD.size());
+        while(true) {
+            std::size_t nameStart = line.find_first_not_of(SPACES);
+            if(nameStart == std::string_view::npos) break;
+
+            line.remove_prefix(nameStart);
+            std::size_t nameEnd = std::min(line.find_first_of(SPACES), line.size());
+            libraries.push_back(objPath.parent_path() / line.substr(0, nameEnd));
+            line.remove_prefix(nameEnd);
+        }
+    }
+    return libraries;
+}
+
+std::uint64_t hashSource(const std::filesystem::path& objPath, const AssetPack* pack) {
+    ResourceFile obj(objPath, pack);
+    if(!obj.isOpen()) return 0;
+
+    std::uint64_t hash = Utils::hashBytes(obj.getData().data(), obj.getData().size());
+    for(const auto& libraryPath : findMaterialLibraries(objPath, obj.getText())) {
+        ResourceFile library(libraryPath, pack);
+        if(library.isOpen()) {
+            hash = Utils::hashBytes(library.getData().data(), library.getData().size(),
+                                    hash);
+        }
+    }
+    return hash;
+}
+
+std::filesystem::path getCachePath(std::uint64_t sourceHash) {
+    std::ostringstream name;
+    name << std::hex << sourceHash << ".vmesh";
+    return std::filesystem::path(Constants::MESH_CACHE_DIR) / name.str();
+}
+
+bool read(const std::filesystem::path& cachePath, std::uint64_t sourceHash,
+          MappedContents& contents) {
+    auto file = std::make_unique<Utils::MappedFile>(cachePath);
+    if(!file->isOpen()) return false;
+
+    Header header;
+    std::size_t offset = 0;
+    if(!readArray(*file, offset, 1, &header) ||
+       std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+       header.version != VERSION || header.sourceHash != sourceHash ||
+       header.vertexSize != sizeof(ObjResource::Vertex)) {
+        Log::debug() << "Ignoring outdated mesh cache '" << cachePath.string() << "'.";
+        return false;
+    }
+
+    // Checked before allocating, so corrupt counts cannot drive the allocations
+    const std::uint64_t expectedSize =
+        sizeof(Header) + std::uint64_t(header.vertexCount) * sizeof(ObjResource::Vertex) +
+        std::uint64_t(header.materialCount) * sizeof(ObjMaterial) +
+        std::uint64_t(header.meshCount) * sizeof(MeshEntry) +
+        std::uint64_t(header.indexCount) * sizeof(unsigned int) + header.nameSize;
+    if(expectedSize != file->getSize()) {
+        Log::warn() << "Mesh cache '" << cachePath.string() << "' is truncated or corrupt.";
+        return false;
+    }
+
+    std::span<const ObjResource::Vertex> vertices;
+    std::span<const MeshEntry> entries;
+    std::span<const unsigned int> indices;
+    std::string names(header.nameSize, '\0');
+    contents.materials.resize(header.materialCount);
+
+    if(!viewArray(*file, offset, header.vertexCount, vertices) ||
+       !readArray(*file, offset, header.materialCount, contents.materials.data()) ||
+       !viewArray(*file, offset, header.meshCount, entries) ||
+       !viewArray(*file, offset, header.indexCount, indices) ||
+       !readArray(*file, offset, header.nameSize, names.data())) {
+        Log::warn() << "Mesh cache '" << cachePath.string() << "' is truncated.";
+        return false;
+    }
+
+    contents.meshes.clear();
+    contents.meshes.reserve(entries.size());
+    for(const MeshEntry& entry : entries) {
+        if(std::size_t(entry.firstIndex) + entry.indexCount > indices.size() ||
+           std::size_t(entry.nameOffset) + entry.nameLength > names.size()) {
+            Log::warn() << "Mesh cache '" << cachePath.string() << "' is corrupt.";
+            return false;
+        }
+
+        contents.meshes.push_back({names.substr(entry.nameOffset, entry.nameLength),
+                                   indices.subspan(entry.firstIndex, entry.indexCount)});
+    }
+
+    contents.file = std::move(file);
+    contents.vertices = vertices;
+    contents.minCorner = header.minCorner;
+    contents.maxCorner = header.maxCorner;
+    return true;
+}
+
+bool write(const std::filesystem::path& cachePath, std::uint64_t sourceHash,
+           const Contents& contents) {
+    std::vector<MeshEntry> entries;
+    std::vector<unsigned int> indices;
+    std::string names;
+    for(const Mesh& mesh : contents.meshes) {
+        entries.push_back({static_cast<std::uint32_t>(indices.size()),
+                           static_cast<std::uint32_t>(mesh.indices.size()),
+                           static_cast<std::uint32_t>(names.size()),
+                           static_cast<std::uint32_t>(mesh.name.size())});
+        indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+        names += mesh.name;
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.sourceHash = sourceHash;
+    header.vertexSize = sizeof(ObjResource::Vertex);
+    header.vertexCount = static_cast<std::uint32_t>(contents.vertices.size());
+    header.materialCount = static_cast<std::uint32_t>(contents.materials.size());
+    header.meshCount = static_cast<std::uint32_t>(entries.size());
+    header.indexCount = static_cast<std::uint32_t>(indices.size());
+    header.nameSize = static_cast<std::uint32_t>(names.size());
+    header.minCorner = contents.minCorner;
+    header.maxCorner = contents.maxCorner;
+
+    return Utils::writeFileAtomically(cachePath, [&](std::ofstream& file) {
+        writeArray(file, &header, 1);
+        writeArray(file, contents.vertices.data(), contents.vertices.size());
+        writeArray(file, contents.materials.data(), contents.materials.size());
+        writeArray(file, entries.data(), entries.size());
+        writeArray(file, indices.data(), indices.size());
+        writeArray(file, names.data(), names.size());
+    });
+}
+} // namespace MeshCache
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ObjMaterial.hpp"
+#include "ObjResource.hpp"
+#include "Systems/ResourceSys/AssetPack.hpp"
+#include "Utils/MappedFile.hpp"
+
+// Binary cache of parsed meshes, so text formats are only parsed once. Cache files
+// are named after the hash of their source files (and referenced material
+// libraries), and read back through a memory mapping.
+namespace MeshCache {
+struct Mesh {
+    std::string name;
+    std::vector<unsigned int> indices;
+};
+
+// Everything needed to upload a resource
+struct Contents {
+    std::vector<ObjResource::Vertex> vertices;
+    std::vector<Mesh> meshes;
+    std::vector<ObjMaterial> materials;
+    glm::vec3 minCorner{0.0f}; // Modelspace bounds
+    glm::vec3 maxCorner{0.0f};
+};
+
+// Contents read back from a cache file. Vertices and indices point into its mapping,
+// which is kept open until they are uploaded; only the small tables are copied.
+struct MappedContents {
+    struct Mesh {
+        std::string name;
+        std::span<const unsigned int> indices;
+    };
+
+    std::unique_ptr<Utils::MappedFile> file;
+    std::span<const ObjResource::Vertex> vertices;
+    std::vector<Mesh> meshes;
+    std::vector<ObjMaterial> materials;
+    glm::vec3 minCorner{0.0f}; // Modelspace bounds
+    glm::vec3 maxCorner{0.0f};
+};
+
+// Material libraries referenced by the 'mtllib' lines of an .obj
+std::vector<std::filesystem::path> findMaterialLibraries(
+    const std::filesystem::path& objPath, std::string_view objText);
+
+// 0 if the source cannot be read. Reads from the pack if given.
+std::uint64_t hashSource(const std::filesystem::path& objPath, const AssetPack* pack);
+std::filesystem::path getCachePath(std::uint64_t sourceHash);
+
+// False on missing, outdated or corrupt cache files
+bool read(const std::filesystem::path& cachePath, std::uint64_t sourceHash,
+          MappedContents& contents);
+bool write(const std::filesystem::path& cachePath, std::uint64_t sourceHash,
+           const Contents& contents);
+} // namespace MeshCache
@@ -25,6 +25,9 @@ ObjBoundingBox::ObjBoundingBox(const ObjResource& resource) {
     calculateModelspaceAABB(resource);
 }
 
+ObjBoundingBox::ObjBoundingBox(const glm::vec3& minCorner, const glm::vec3& maxCorner)
+    : minCorner(minCorner), maxCorner(maxCorner) {}
+
 std::pair<glm::vec3, glm::vec3> ObjBoundingBox::getWorldspaceAABB(
     const glm::mat4& modelMatrix) const {
     glm::vec3 outMinCorner = glm::vec3(std::numeric_limits<float>::max());
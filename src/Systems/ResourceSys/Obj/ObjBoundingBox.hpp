@@ -19,8 +19,12 @@ public:
     static Ptr create(const ObjResource& resource) {
         return std::make_shared<ObjBoundingBox>(resource);
     }
+    static Ptr create(const glm::vec3& minCorner, const glm::vec3& maxCorner) {
+        return std::make_shared<ObjBoundingBox>(minCorner, maxCorner);
+    }
 
     ObjBoundingBox(const ObjResource& resource);
+    ObjBoundingBox(const glm::vec3& minCorner, const glm::vec3& maxCorner);
     std::pair<glm::vec3, glm::vec3> getWorldspaceAABB(const glm::mat4& modelMatrix) const;
 
 private:
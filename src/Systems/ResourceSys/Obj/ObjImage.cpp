@@ -1,5 +1,8 @@
 #include "ObjImage.hpp"
 
+#include <algorithm>
+#include <bit>
+
 ObjImage::ObjImage(std::string name, GLuint textureId, int width, int height)
     : name(std::move(name)), textureId(textureId), width(width), height(height) {}
 
@@ -14,4 +17,9 @@ ObjImage::ObjImage(ObjImage&& o) {
     o.textureId = 0;
 }
 
-ObjImage::~ObjImage() { glDeleteTextures(1, &textureId); }
\ No newline at end of file
+ObjImage::~ObjImage() { glDeleteTextures(1, &textureId); }
+
+// Full mip chain, down to 1x1
+int ObjImage::getLevelCount() const {
+    return std::bit_width(static_cast<unsigned>(std::max(width, height)));
+}
\ No newline at end of file
@@ -2,9 +2,13 @@
 
 #include <glad/glad.h>
 
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
+#include <vector>
+
+#include "TextureCompression.hpp"
 
 class ObjImage {
 public:
@@ -12,9 +16,23 @@ public:
     using CPtr = std::shared_ptr<const ObjImage>;
 
     std::string name;
-    GLuint textureId = 0;
+    GLuint textureId = 0; // 0 until uploaded, see TextureUploader
     int width;
     int height;
+    int resourceCount = 0; // Resources sharing it through TextureCache, main thread
+
+    // Mip levels on the GPU, managed by TextureStreamer on the main thread
+    struct Residency {
+        std::shared_ptr<const std::vector<unsigned char>> sourcePixels; // Level 0
+        // Replaces the source pixels if baked
+        std::shared_ptr<const TextureCompression::CompressedImage> compressedSource;
+        int components = 4;
+        GLenum internalFormat = GL_RGBA8;
+        int residentLevel = 0;     // Finest level in textureId
+        int requestedLevel = -1;   // Finest level drawn this frame, -1 if not drawn
+        bool loading = false;      // A finer level is on its way
+        std::uint64_t lastUse = 0; // Streamer frame
+    } residency;
 
     static Ptr create(std::string name, GLuint textureId, int width, int height) {
         return std::make_shared<ObjImage>(std::move(name), textureId, width, height);
@@ -26,4 +44,6 @@ public:
     ~ObjImage();
     ObjImage& operator=(const ObjImage&) = delete;
     ObjImage& operator=(ObjImage&&) = delete;
+
+    int getLevelCount() const;
 };
\ No newline at end of file
@@ -6,5 +6,10 @@ class ObjResource;
 class ObjLoader {
 public:
     virtual ~ObjLoader() = default;
-    virtual bool load(ObjResource& resource) = 0;
+
+    // Reads and decodes the file into CPU memory. Makes no GL calls, so it can run
+    // on a worker thread.
+    virtual bool parse() = 0;
+    // Creates the GL objects of the resource from the parsed data. Main thread only.
+    virtual bool upload(ObjResource& resource) = 0;
 };
@@ -13,4 +13,14 @@ struct ObjMaterial {
     float metallic;
     float roughness;
     float sheen;
+
+    // Index in the resource's texture arrays and layer in it, -1 if not packed
+    int baseColorArray = -1;
+    int baseColorLayer = -1;
+    int normalArray = -1;
+    int normalLayer = -1;
+    int metallicRoughnessArray = -1;
+    int metallicRoughnessLayer = -1;
+    float p3;
+    float p4;
 };
\ No newline at end of file
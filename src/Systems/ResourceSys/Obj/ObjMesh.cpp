@@ -5,3 +5,9 @@ ObjMesh::ObjMesh(ObjResource& parent, const std::string& name,
     : name(name), parent(parent), indices(std::move(indices)) {
     indexBuffer.setData<unsigned int>(GL_ELEMENT_ARRAY_BUFFER, this->indices);
 }
+
+ObjMesh::ObjMesh(ObjResource& parent, const std::string& name,
+                 std::span<const unsigned int> indices)
+    : name(name), parent(parent) {
+    indexBuffer.setData(GL_ELEMENT_ARRAY_BUFFER, indices);
+}
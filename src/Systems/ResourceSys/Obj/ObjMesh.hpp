@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
 #include <glm/glm.hpp>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -9,6 +11,7 @@
 #include "Animation/Skin.hpp"
 #include "GPUBuffer.hpp"
 #include "ObjTexture.hpp"
+#include "ObjTextureArray.hpp"
 
 class ObjResource;
 class ObjMesh {
@@ -19,11 +22,15 @@ public:
     std::string name;
     ObjResource& parent;
     GPUBuffer indexBuffer;
-    std::vector<unsigned int> indices;
+    std::vector<unsigned int> indices; // CPU copy, empty if created from a span
     glm::mat4 transform{1.0f};
 
-    AnimationNode* animationNode = nullptr; // Optional
-    Skin::Ptr skin = nullptr;               // Optional
+    // Range of the vertices used by this mesh in parent's vertices, if known
+    unsigned int firstVertex = 0;
+    unsigned int vertexCount = 0;
+
+    int animationNode = -1;    // Optional, node index in animation container
+    Skin::CPtr skin = nullptr; // Optional
 
     // Optional textures
     ObjTexture::Ptr baseColorTexture;
@@ -31,12 +38,22 @@ public:
     ObjTexture::Ptr metallicRoughnessTexture;
     ObjTexture::Ptr emissiveTexture;
     float normalScale = 1.0f;
+    // Optional, by slot. Replaces the texture of packed slots, sampled at the layer of
+    // the material.
+    std::array<ObjTextureArray::Ptr, ObjTextureArray::COUNT> textureArrays;
 
     static Ptr create(ObjResource& parent, const std::string& name,
                       std::vector<unsigned int> indices) {
         return std::make_shared<ObjMesh>(parent, name, std::move(indices));
     }
+    // Uploads the indices without keeping a copy
+    static Ptr create(ObjResource& parent, const std::string& name,
+                      std::span<const unsigned int> indices) {
+        return std::make_shared<ObjMesh>(parent, name, indices);
+    }
 
     ObjMesh(ObjResource& parent, const std::string& name,
             std::vector<unsigned int> indices);
+    ObjMesh(ObjResource& parent, const std::string& name,
+            std::span<const unsigned int> indices);
 };
\ No newline at end of file
@@ -0,0 +1,429 @@
+#include "ObjParser.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "Log.hpp"
+#include "Systems/ResourceSys/AssetPack.hpp"
+#include "Utils/ThreadPool.hpp"
+
+namespace {
+// Smaller files are parsed on the calling thread
+constexpr std::size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+// A shape or material change, applied before the chunk's triangle at its offset
+struct Event {
+    enum class Type { Shape, Material } type;
+    std::size_t triangle;
+    std::string_view name;
+};
+
+// Lines parsed by one thread. Negative (relative) indices are resolved against the
+// attributes of the chunk, and offset by those of the previous chunks when merging.
+struct Chunk {
+    std::string_view text;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texcoords;
+    std::vector<ObjParser::Index> indices; // 3 per triangle
+    std::vector<std::size_t> relativePositions; // Into indices
+    std::vector<std::size_t> relativeNormals;
+    std::vector<std::size_t> relativeTexcoords;
+    std::vector<Event> events;
+    std::vector<std::string_view> materialLibraries;
+    std::string error; // Empty if parsed
+};
+
+// Face corner, before triangulation
+struct Corner {
+    ObjParser::Index index;
+    bool relativePosition = false;
+    bool relativeNormal = false;
+    bool relativeTexcoord = false;
+};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+std::string_view trim(std::string_view text) {
+    while(!text.empty() && isSpace(text.front())) text.remove_prefix(1);
+    while(!text.empty() && isSpace(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+std::string_view readLine(std::string_view& text) {
+    std::size_t lineEnd = text.find('\n');
+    std::string_view line = text.substr(0, lineEnd);
+    text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+    return line;
+}
+
+// Cursor over the words and numbers of a line
+class LineReader {
+public:
+    explicit LineReader(std::string_view line)
+        : mPos(line.data()), mEnd(line.data() + line.size()) {}
+
+    bool atEnd() {
+        skipSpaces();
+        return mPos == mEnd;
+    }
+    bool atWordEnd() const { return mPos == mEnd || isSpace(*mPos); }
+
+    std::string_view readWord() {
+        skipSpaces();
+        const char* start = mPos;
+        while(mPos != mEnd && !isSpace(*mPos)) ++mPos;
+        return {start, static_cast<std::size_t>(mPos - start)};
+    }
+
+    std::string_view readRest() {
+        return trim({mPos, static_cast<std::size_t>(mEnd - mPos)});
+    }
+
+    bool readFloat(float& value) {
+        skipSpaces();
+        if(mPos != mEnd && *mPos == '+') ++mPos; // Not accepted by from_chars
+        auto [end, error] = std::from_chars(mPos, mEnd, value);
+        if(error == std::errc::invalid_argument) return false;
+        if(error == std::errc::result_out_of_range) value = 0.0f; // Too small or big
+        mPos = end;
+        return atWordEnd();
+    }
+
+    // Doesn't skip spaces, to read the parts of face corners
+    bool readInt(int& value) {
+        bool negative = false;
+        if(mPos != mEnd && (*mPos == '-' || *mPos == '+')) {
+            negative = *mPos++ == '-';
+        }
+        if(mPos == mEnd || *mPos < '0' || *mPos > '9') return false;
+
+        int result = 0;
+        while(mPos != mEnd && *mPos >= '0' && *mPos <= '9') {
+            result = result * 10 + (*mPos++ - '0');
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+    bool consume(char c) {
+        if(mPos == mEnd || *mPos != c) return false;
+        ++mPos;
+        return true;
+    }
+
+private:
+    const char* mPos;
+    const char* mEnd;
+
+    void skipSpaces() {
+        while(mPos != mEnd && isSpace(*mPos)) ++mPos;
+    }
+};
+
+bool readVec3(LineReader& reader, glm::vec3& value) {
+    return reader.readFloat(value.x) && reader.readFloat(value.y) &&
+           reader.readFloat(value.z);
+}
+
+// Colors can be given as a single value
+bool readColor(LineReader& reader, glm::vec3& color) {
+    if(!reader.readFloat(color.x)) return false;
+    if(reader.atEnd()) {
+        color.y = color.z = color.x;
+        return true;
+    }
+    return reader.readFloat(color.y) && reader.readFloat(color.z);
+}
+
+// Indices are 1-based, or negative to count back from the last attribute
+bool readIndex(LineReader& reader, std::size_t attributeCount, int& index,
+               bool& relative) {
+    int value = 0;
+    if(!reader.readInt(value) || value == 0) return false;
+
+    relative = value < 0;
+    index = relative ? static_cast<int>(attributeCount) + value : value - 1;
+    return true;
+}
+
+// Corners are "p", "p/t", "p//n" or "p/t/n". Polygons are triangulated as fans.
+bool parseFace(LineReader& reader, Chunk& chunk, std::vector<Corner>& corners) {
+    corners.clear();
+    while(!reader.atEnd()) {
+        Corner& corner = corners.emplace_back();
+        if(!readIndex(reader, chunk.positions.size(), corner.index.position,
+                      corner.relativePosition)) {
+            return false;
+        }
+
+        if(reader.consume('/')) {
+            if(!reader.consume('/')) {
+                if(!readIndex(reader, chunk.texcoords.size(), corner.index.texcoord,
+                              corner.relativeTexcoord)) {
+                    return false;
+                }
+                if(!reader.consume('/')) continue;
+            }
+            if(!readIndex(reader, chunk.normals.size(), corner.index.normal,
+                          corner.relativeNormal)) {
+                return false;
+            }
+        }
+        if(!reader.atWordEnd()) return false;
+    }
+    if(corners.size() < 3) return false;
+
+    auto addCorner = [&chunk](const Corner& corner) {
+        std::size_t index = chunk.indices.size();
+        if(corner.relativePosition) chunk.relativePositions.push_back(index);
+        if(corner.relativeNormal) chunk.relativeNormals.push_back(index);
+        if(corner.relativeTexcoord) chunk.relativeTexcoords.push_back(index);
+        chunk.indices.push_back(corner.index);
+    };
+    for(std::size_t i = 1; i + 1 < corners.size(); ++i) {
+        addCorner(corners[0]);
+        addCorner(corners[i]);
+        addCorner(corners[i + 1]);
+    }
+    return true;
+}
+
+void parseChunk(Chunk& chunk) {
+    std::vector<Corner> corners; // Reused for every face
+    std::string_view text = chunk.text;
+
+    while(!text.empty()) {
+        std::string_view line = readLine(text);
+        LineReader reader(line);
+        std::string_view keyword = reader.readWord();
+
+        bool valid = true;
+        if(keyword == "v") {
+            valid = readVec3(reader, chunk.positions.emplace_back());
+        } else if(keyword == "vn") {
+            valid = readVec3(reader, chunk.normals.emplace_back());
+        } else if(keyword == "vt") {
+            glm::vec2& texcoord = chunk.texcoords.emplace_back(0.0f);
+            valid = reader.readFloat(texcoord.x) &&
+                    (reader.atEnd() || reader.readFloat(texcoord.y));
+        } else if(keyword == "f") {
+            valid = parseFace(reader, chunk, corners);
+        } else if(keyword == "o" || keyword == "g") {
+            chunk.events.push_back(
+                {Event::Type::Shape, chunk.indices.size() / 3, reader.readRest()});
+        } else if(keyword == "usemtl") {
+            chunk.events.push_back(
+                {Event::Type::Material, chunk.indices.size() / 3, reader.readRest()});
+        } else if(keyword == "mtllib") {
+            while(!reader.atEnd()) {
+                chunk.materialLibraries.push_back(reader.readWord());
+            }
+        }
+        // Anything else (comments, smoothing groups, lines...) is ignored
+
+        if(!valid) {
+            chunk.error = "invalid line '" + std::string(trim(line)) + "'";
+            return;
+        }
+    }
+}
+
+bool isValidIndex(int index, std::size_t attributeCount) {
+    return index >= 0 && static_cast<std::size_t>(index) < attributeCount;
+}
+} // namespace
+
+bool ObjParser::parse(const std::filesystem::path& path, const AssetPack* pack,
+                      std::size_t threadCount) {
+    ResourceFile file(path, pack);
+    if(!file.isOpen()) {
+        Log::error() << "Cannot read '" << path.string() << "'!";
+        return false;
+    }
+    return parse(file.getText(), path, pack, threadCount);
+}
+
+bool ObjParser::parse(std::string_view text, const std::filesystem::path& path,
+                      const AssetPack* pack, std::size_t threadCount) {
+    mPositions.clear();
+    mNormals.clear();
+    mTexcoords.clear();
+    mShapes.clear();
+    mMaterials.clear();
+
+    // Split into chunks ending on line ends
+    if(threadCount == 0) {
+        threadCount = Utils::ThreadPool::isWorkerThread()
+                          ? 1
+                          : std::max(1u, std::thread::hardware_concurrency());
+    }
+    mChunkCount = std::clamp<std::size_t>(text.size() / MIN_CHUNK_SIZE, 1, threadCount);
+    std::vector<Chunk> chunks(mChunkCount);
+    std::size_t chunkStart = 0;
+    for(std::size_t i = 0; i < mChunkCount; ++i) {
+        std::size_t chunkEnd = text.size();
+        if(i + 1 < mChunkCount) {
+            std::size_t splitPos = text.size() * (i + 1) / mChunkCount;
+            std::size_t lineEnd = text.find('\n', std::max(chunkStart, splitPos));
+            chunkEnd = lineEnd == std::string_view::npos ? text.size() : lineEnd + 1;
+        }
+        chunks[i].text = text.substr(chunkStart, chunkEnd - chunkStart);
+        chunkStart = chunkEnd;
+    }
+
+    if(mChunkCount == 1) {
+        parseChunk(chunks[0]);
+    } else {
+        Utils::ThreadPool threadPool(mChunkCount);
+        for(Chunk& chunk : chunks) {
+            threadPool.submit([&chunk] { parseChunk(chunk); });
+        }
+        threadPool.wait();
+    }
+
+    for(const Chunk& chunk : chunks) {
+        if(!chunk.error.empty()) {
+            Log::error() << "Failed to parse '" << path.string() << "': " << chunk.error
+                         << "!";
+            return false;
+        }
+    }
+
+    // Materials first, since they are used by name
+    std::vector<std::string_view> libraries;
+    for(const Chunk& chunk : chunks) {
+        for(std::string_view library : chunk.materialLibraries) {
+            auto it = std::find(libraries.begin(), libraries.end(), library);
+            if(it == libraries.end()) libraries.push_back(library);
+        }
+    }
+    for(std::string_view library : libraries) {
+        parseMaterialLibrary(path.parent_path() / library, pack);
+    }
+    std::unordered_map<std::string_view, int> materialIds;
+    for(std::size_t i = 0; i < mMaterials.size(); ++i) {
+        materialIds.emplace(mMaterials[i].name, static_cast<int>(i));
+    }
+
+    // Merge in order, carrying the current shape and material across chunks
+    std::size_t positionCount = 0;
+    std::size_t normalCount = 0;
+    std::size_t texcoordCount = 0;
+    for(const Chunk& chunk : chunks) {
+        positionCount += chunk.positions.size();
+        normalCount += chunk.normals.size();
+        texcoordCount += chunk.texcoords.size();
+    }
+    mPositions.reserve(positionCount);
+    mNormals.reserve(normalCount);
+    mTexcoords.reserve(texcoordCount);
+
+    Shape shape;
+    int materialId = -1;
+    for(Chunk& chunk : chunks) {
+        for(std::size_t i : chunk.relativePositions) {
+            chunk.indices[i].position += static_cast<int>(mPositions.size());
+        }
+        for(std::size_t i : chunk.relativeNormals) {
+            chunk.indices[i].normal += static_cast<int>(mNormals.size());
+        }
+        for(std::size_t i : chunk.relativeTexcoords) {
+            chunk.indices[i].texcoord += static_cast<int>(mTexcoords.size());
+        }
+        mPositions.insert(mPositions.end(), chunk.positions.begin(),
+                          chunk.positions.end());
+        mNormals.insert(mNormals.end(), chunk.normals.begin(), chunk.normals.end());
+        mTexcoords.insert(mTexcoords.end(), chunk.texcoords.begin(),
+                          chunk.texcoords.end());
+
+        for(const Index& index : chunk.indices) {
+            if(!isValidIndex(index.position, positionCount) ||
+               (index.normal != -1 && !isValidIndex(index.normal, normalCount)) ||
+               (index.texcoord != -1 && !isValidIndex(index.texcoord, texcoordCount))) {
+                Log::error() << "Failed to parse '" << path.string()
+                             << "': face index out of range!";
+                return false;
+            }
+        }
+
+        std::size_t triangle = 0;
+        auto addTriangles = [&](std::size_t end) {
+            shape.indices.insert(shape.indices.end(),
+                                 chunk.indices.begin() + triangle * 3,
+                                 chunk.indices.begin() + end * 3);
+            shape.materialIds.insert(shape.materialIds.end(), end - triangle, materialId);
+            triangle = end;
+        };
+        for(const Event& event : chunk.events) {
+            addTriangles(event.triangle);
+            if(event.type == Event::Type::Shape) {
+                if(!shape.indices.empty()) mShapes.push_back(std::move(shape));
+                shape = Shape{std::string(event.name), {}, {}};
+            } else if(auto it = materialIds.find(event.name); it != materialIds.end()) {
+                materialId = it->second;
+            } else {
+                Log::warn() << "Unknown material '" << event.name << "' in '"
+                            << path.string() << "'.";
+                materialId = -1;
+            }
+        }
+        addTriangles(chunk.indices.size() / 3);
+    }
+    if(!shape.indices.empty()) mShapes.push_back(std::move(shape));
+
+    return true;
+}
+
+bool ObjParser::parseMaterialLibrary(const std::filesystem::path& path,
+                                     const AssetPack* pack) {
+    ResourceFile file(path, pack);
+    if(!file.isOpen()) {
+        Log::warn() << "Cannot read material library '" << path.string() << "'.";
+        return false;
+    }
+
+    std::string_view text = file.getText();
+    Material* material = nullptr;
+    while(!text.empty()) {
+        std::string_view line = readLine(text);
+        LineReader reader(line);
+        std::string_view keyword = reader.readWord();
+
+        if(keyword == "newmtl") {
+            material = &mMaterials.emplace_back();
+            material->name = reader.readRest();
+            continue;
+        }
+        if(!material) continue;
+
+        bool valid = true;
+        if(keyword == "Kd") {
+            valid = readColor(reader, material->diffuse);
+        } else if(keyword == "Ks") {
+            valid = readColor(reader, material->specular);
+        } else if(keyword == "Ke") {
+            valid = readColor(reader, material->emission);
+        } else if(keyword == "Ns") {
+            valid = reader.readFloat(material->shininess);
+        } else if(keyword == "d") {
+            valid = reader.readFloat(material->dissolve);
+        } else if(keyword == "Tr") {
+            float transparency = 0.0f;
+            valid = reader.readFloat(transparency);
+            material->dissolve = 1.0f - transparency;
+        }
+
+        if(!valid) {
+            Log::warn() << "Ignoring invalid line '" << trim(line)
+                        << "' in material library '" << path.string() << "'.";
+        }
+    }
+    return true;
+}
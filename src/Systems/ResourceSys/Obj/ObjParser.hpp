@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class AssetPack;
+
+// Wavefront .obj reader, which splits the file into line-aligned chunks parsed in
+// parallel and merges them in order.
+// Reads positions, normals, texcoords, faces (triangulated as fans), objects and
+// groups (as shapes), and materials from .mtl libraries.
+class ObjParser {
+public:
+    struct Index {
+        int position = -1;
+        int normal = -1;   // -1 if missing
+        int texcoord = -1; // -1 if missing
+    };
+
+    struct Shape {
+        std::string name;
+        std::vector<Index> indices;   // 3 per triangle
+        std::vector<int> materialIds; // Per triangle, -1 if none
+    };
+
+    // Same defaults as tinyobjloader
+    struct Material {
+        std::string name;
+        glm::vec3 diffuse{0.0f};
+        glm::vec3 specular{0.0f};
+        glm::vec3 emission{0.0f};
+        float shininess = 1.0f;
+        float dissolve = 1.0f; // 1 is opaque
+    };
+
+    // Material libraries are found relative to path, and read from the pack if given.
+    // A threadCount of 0 uses one thread per hardware thread, or only this one if it
+    // already belongs to a thread pool.
+    bool parse(const std::filesystem::path& path, const AssetPack* pack = nullptr,
+               std::size_t threadCount = 0);
+    bool parse(std::string_view text, const std::filesystem::path& path,
+               const AssetPack* pack = nullptr, std::size_t threadCount = 0);
+
+    const std::vector<glm::vec3>& getPositions() const { return mPositions; }
+    const std::vector<glm::vec3>& getNormals() const { return mNormals; }
+    const std::vector<glm::vec2>& getTexcoords() const { return mTexcoords; }
+    const std::vector<Shape>& getShapes() const { return mShapes; }
+    const std::vector<Material>& getMaterials() const { return mMaterials; }
+    std::size_t getChunkCount() const { return mChunkCount; }
+
+private:
+    std::vector<glm::vec3> mPositions;
+    std::vector<glm::vec3> mNormals;
+    std::vector<glm::vec2> mTexcoords;
+    std::vector<Shape> mShapes;
+    std::vector<Material> mMaterials;
+    std::size_t mChunkCount = 0; // Of the last parse
+
+    bool parseMaterialLibrary(const std::filesystem::path& path, const AssetPack* pack);
+};
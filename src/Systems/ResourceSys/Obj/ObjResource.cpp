@@ -1,6 +1,63 @@
 #include "ObjResource.hpp"
 
-ObjResource::ObjResource(std::unique_ptr<ObjLoader> loader) {
-    loader->load(*this);
-    boundingBox = ObjBoundingBox::create(*this);
-}
\ No newline at end of file
+#include <algorithm>
+
+ObjResource::ObjResource(ObjLoader& loader) {
+    loader.upload(*this);
+    if(!boundingBox) { // Unless the loader already knows it
+        boundingBox = ObjBoundingBox::create(*this);
+    }
+    for(const auto& image : objImages) ++image->resourceCount;
+    for(const auto& array : objTextureArrays) ++array->resourceCount;
+}
+
+ObjResource::~ObjResource() {
+    for(const auto& image : objImages) --image->resourceCount;
+    for(const auto& array : objTextureArrays) --array->resourceCount;
+}
+
+std::size_t ObjResource::getCPUMemoryUsage() const {
+    std::size_t usage = vertices.size() * sizeof(Vertex);
+    for(const auto& mesh : objMeshes) {
+        usage += mesh->indices.size() * sizeof(unsigned int);
+    }
+
+    if(animationContainer) {
+        for(const auto& animation : animationContainer->getAnimations()) {
+            if(animation) usage += animation->getMemoryUsage();
+        }
+    }
+    for(const auto& image : objImages) {
+        // Kept for mip streaming
+        std::size_t imageUsage = 0;
+        if(image->residency.sourcePixels) {
+            imageUsage += image->residency.sourcePixels->size();
+        }
+        if(image->residency.compressedSource) {
+            for(const auto& level : image->residency.compressedSource->levels) {
+                imageUsage += level.size();
+            }
+        }
+        usage += imageUsage / std::max(image->resourceCount, 1);
+    }
+    return usage;
+}
+
+std::size_t ObjResource::getGPUMemoryUsage() const {
+    std::size_t usage = vertexBuffer.getSize() + materialUniformBuffer.getSize();
+    for(const auto& mesh : objMeshes) {
+        usage += mesh->indexBuffer.getSize();
+    }
+
+    // Assumes RGBA8, with a third more for mipmaps. Evicting a resource only frees its
+    // share of the images other resources still use.
+    for(const auto& image : objImages) {
+        usage += static_cast<std::size_t>(image->width) * image->height * 4 * 4 / 3 /
+                 std::max(image->resourceCount, 1);
+    }
+    for(const auto& array : objTextureArrays) {
+        usage += static_cast<std::size_t>(array->width) * array->height *
+                 array->layerCount * 4 * 4 / 3 / std::max(array->resourceCount, 1);
+    }
+    return usage;
+}
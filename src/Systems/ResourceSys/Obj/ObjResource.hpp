@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 #include "Animation/AnimationContainer.hpp"
@@ -8,12 +9,17 @@
 #include "ObjLoader.hpp"
 #include "ObjMesh.hpp"
 #include "ObjTexture.hpp"
+#include "ObjTextureArray.hpp"
 #include "ObjBoundingBox.hpp"
+#include "Systems/ResourceSys/ResourceHandle.hpp"
+#include "Utils/Identifiable.hpp"
 
-class ObjResource {
+// Ids tell apart resources reloaded at the same address
+class ObjResource : public Utils::Identifiable<ObjResource> {
 public:
     using Ptr = std::shared_ptr<ObjResource>;
     using CPtr = std::shared_ptr<const ObjResource>;
+    using Handle = ResourceHandle<ObjResource>;
 
     struct Vertex {
         glm::vec3 position;
@@ -28,16 +34,22 @@ public:
 
     GPUBuffer vertexBuffer;
     GPUBuffer materialUniformBuffer;
-    std::vector<Vertex> vertices; // Same vertex data as in vertexBuffer
+    std::vector<Vertex> vertices; // CPU copy of vertexBuffer, if the loader keeps one
     std::vector<ObjMesh::Ptr> objMeshes;
     std::vector<ObjImage::Ptr> objImages;
     std::vector<ObjTexture::Ptr> objTextures;
+    // Optional. Packed textures are set on the meshes as arrays.
+    std::vector<ObjTextureArray::Ptr> objTextureArrays;
     ObjBoundingBox::Ptr boundingBox;
     AnimationContainer::Ptr animationContainer; // Optional
 
-    static Ptr create(std::unique_ptr<ObjLoader> loader) {
-        return std::make_shared<ObjResource>(std::move(loader));
-    }
+    static Ptr create(ObjLoader& loader) { return std::make_shared<ObjResource>(loader); }
 
-    ObjResource(std::unique_ptr<ObjLoader> loader);
+    // The loader must already be parsed
+    ObjResource(ObjLoader& loader);
+    ~ObjResource();
+
+    // Approximate, in bytes. Shared images are split between the resources using them.
+    std::size_t getCPUMemoryUsage() const;
+    std::size_t getGPUMemoryUsage() const;
 };
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include "ObjSampler.hpp"
+
+// GL enums fit in 16 bits, so parameters never share a key
+std::uint64_t ObjSampler::Parameters::getKey() const {
+    return (static_cast<std::uint64_t>(minFilter & 0xffff) << 48) |
+           (static_cast<std::uint64_t>(magFilter & 0xffff) << 32) |
+           (static_cast<std::uint64_t>(wrapS & 0xffff) << 16) | (wrapT & 0xffff);
+}
+
+ObjSampler::ObjSampler(const Parameters& parameters) {
+    glGenSamplers(1, &samplerId);
+    glSamplerParameteri(samplerId, GL_TEXTURE_MIN_FILTER, parameters.minFilter);
+    glSamplerParameteri(samplerId, GL_TEXTURE_MAG_FILTER, parameters.magFilter);
+    glSamplerParameteri(samplerId, GL_TEXTURE_WRAP_S, parameters.wrapS);
+    glSamplerParameteri(samplerId, GL_TEXTURE_WRAP_T, parameters.wrapT);
+}
+
+ObjSampler::~ObjSampler() { glDeleteSamplers(1, &samplerId); }
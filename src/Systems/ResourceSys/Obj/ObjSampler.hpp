@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <memory>
+
+// GL sampler object, shared by every texture with the same parameters, see
+// TextureCache
+class ObjSampler {
+public:
+    using Ptr = std::shared_ptr<ObjSampler>;
+    using CPtr = std::shared_ptr<const ObjSampler>;
+
+    struct Parameters {
+        GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+        GLenum magFilter = GL_LINEAR;
+        GLenum wrapS = GL_REPEAT;
+        GLenum wrapT = GL_REPEAT;
+
+        std::uint64_t getKey() const;
+    };
+
+    GLuint samplerId = 0;
+
+    static Ptr create(const Parameters& parameters) {
+        return std::make_shared<ObjSampler>(parameters);
+    }
+
+    ObjSampler(const Parameters& parameters);
+    ~ObjSampler();
+    ObjSampler(const ObjSampler&) = delete;
+    ObjSampler& operator=(const ObjSampler&) = delete;
+};
@@ -1,12 +1,11 @@
 #pragma once
 
-#include <glad/glad.h>
-
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
 
 #include "ObjImage.hpp"
+#include "ObjSampler.hpp"
 
 class ObjTexture {
 public:
@@ -15,16 +14,12 @@ public:
 
     std::string name;
     ObjImage::Ptr image = nullptr;
-    GLuint samplerId = 0;
+    ObjSampler::CPtr sampler = nullptr; // Shared, see TextureCache
 
-    static Ptr create(std::string name, ObjImage::Ptr image, GLuint samplerId) {
-        return std::make_shared<ObjTexture>(std::move(name), std::move(image), samplerId);
+    static Ptr create(std::string name, ObjImage::Ptr image, ObjSampler::CPtr sampler) {
+        return std::make_shared<ObjTexture>(std::move(name), std::move(image),
+                                            std::move(sampler));
     }
 
-    ObjTexture(std::string name, ObjImage::Ptr image, GLuint samplerId);
-    ObjTexture(const ObjTexture& o);
-    ObjTexture(ObjTexture&& o);
-    ~ObjTexture();
-    ObjTexture& operator=(const ObjTexture&) = delete;
-    ObjTexture& operator=(ObjTexture&&) = delete;
+    ObjTexture(std::string name, ObjImage::Ptr image, ObjSampler::CPtr sampler);
 };
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include "ObjTextureArray.hpp"
+
+#include <algorithm>
+#include <bit>
+
+ObjTextureArray::ObjTextureArray(int width, int height, int layerCount,
+                                 GLenum internalFormat, ObjSampler::CPtr sampler)
+    : width(width), height(height), layerCount(layerCount),
+      internalFormat(internalFormat), sampler(std::move(sampler)) {
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, getLevelCount(), internalFormat, width, height,
+                   layerCount);
+}
+
+ObjTextureArray::~ObjTextureArray() { glDeleteTextures(1, &textureId); }
+
+// Full mip chain, like ObjImage
+int ObjTextureArray::getLevelCount() const {
+    return std::bit_width(static_cast<unsigned>(std::max(width, height)));
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <memory>
+
+#include "ObjSampler.hpp"
+
+// Images of the same size, format and sampler packed as the layers of one
+// GL_TEXTURE_2D_ARRAY, so the meshes using them sample them with a single bind.
+// Meshes pick their layer through their material. Layers are uploaded whole by the
+// TextureUploader, and aren't streamed. Shared through the TextureCache.
+class ObjTextureArray {
+public:
+    using Ptr = std::shared_ptr<ObjTextureArray>;
+    using CPtr = std::shared_ptr<const ObjTextureArray>;
+
+    // Material textures which can be packed
+    enum Slot { BaseColor = 0, Normal, MetallicRoughness, COUNT };
+
+    GLuint textureId = 0;
+    int width;
+    int height;
+    int layerCount;
+    GLenum internalFormat;
+    ObjSampler::CPtr sampler;
+    int uploadedLayers = 0; // Sampled once all are, see TextureUploader
+    int resourceCount = 0;  // Resources sharing it through TextureCache, main thread
+
+    static Ptr create(int width, int height, int layerCount, GLenum internalFormat,
+                      ObjSampler::CPtr sampler) {
+        return std::make_shared<ObjTextureArray>(width, height, layerCount,
+                                                 internalFormat, std::move(sampler));
+    }
+
+    // Main thread, allocates every layer with its mip chain
+    ObjTextureArray(int width, int height, int layerCount, GLenum internalFormat,
+                    ObjSampler::CPtr sampler);
+    ~ObjTextureArray();
+    ObjTextureArray(const ObjTextureArray&) = delete;
+    ObjTextureArray& operator=(const ObjTextureArray&) = delete;
+
+    int getLevelCount() const;
+    bool isComplete() const { return uploadedLayers == layerCount; }
+};
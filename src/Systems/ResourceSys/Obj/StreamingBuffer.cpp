@@ -0,0 +1,173 @@
+#include "StreamingBuffer.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "Log.hpp"
+
+namespace {
+std::size_t alignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+// Static. Loaded ourselves since we only require 4.3.
+StreamingBuffer::BufferStorageProc StreamingBuffer::loadBufferStorage() {
+    bool supported = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4);
+    if(!supported) {
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for(GLint i = 0; i < extensionCount && !supported; ++i) {
+            const char* extension =
+                reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            supported = extension && std::strcmp(extension, "GL_ARB_buffer_storage") == 0;
+        }
+    }
+
+    return supported
+               ? reinterpret_cast<BufferStorageProc>(SDL_GL_GetProcAddress("glBufferStorage"))
+               : nullptr;
+}
+
+StreamingBuffer::StreamingBuffer(std::size_t frameSize) {
+    GLint uniformAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+    if(uniformAlignment > 0) {
+        mUniformAlignment = static_cast<std::size_t>(uniformAlignment);
+    }
+    GLint storageAlignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+    if(storageAlignment > 0) {
+        mStorageAlignment = static_cast<std::size_t>(storageAlignment);
+    }
+
+    // Keep every region start aligned for any kind of binding
+    mFrameSize = alignUp(frameSize, std::max(mUniformAlignment, mStorageAlignment));
+    const GLsizeiptr totalSize = static_cast<GLsizeiptr>(mFrameSize * FRAME_COUNT);
+
+    glGenBuffers(1, &mId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mId);
+
+    if(BufferStorageProc bufferStorage = loadBufferStorage()) {
+        const GLbitfield flags =
+            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        bufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+        mPersistentData = static_cast<unsigned char*>(
+            glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+    }
+
+    if(!mPersistentData) {
+        // Regular storage, mapped per frame region
+        glBufferData(GL_COPY_WRITE_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    Log::debug() << "Created " << (isPersistent() ? "persistent" : "non-persistent")
+                 << " streaming buffer of " << totalSize << " bytes.";
+}
+
+StreamingBuffer::~StreamingBuffer() {
+    for(GLsync fence : mFences) {
+        if(fence) {
+            glDeleteSync(fence);
+        }
+    }
+
+    if(mPersistentData || mMappedData) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mId);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &mId);
+}
+
+// Returns a chunk of the current frame's region, valid until the end of the frame.
+// flush() must be called before the GPU reads from it.
+StreamingBuffer::Allocation StreamingBuffer::allocate(std::size_t size,
+                                                      std::size_t alignment) {
+    const std::size_t regionBegin = getRegionBegin();
+    const std::size_t offset = alignUp(regionBegin + mHead, alignment);
+
+    if(size == 0 || offset + size > regionBegin + mFrameSize) {
+        if(size != 0 && !mOverflowed) {
+            Log::warn() << "Streaming buffer is full, dropping " << size
+                        << " bytes this frame!";
+            mOverflowed = true;
+        }
+        return {};
+    }
+
+    unsigned char* data = nullptr;
+    if(mPersistentData) {
+        data = mPersistentData + offset;
+    } else {
+        if(!mMappedData) {
+            // Map what is left of the region. Fences already guarantee the GPU is
+            // done with it, so there is no need for the driver to sync.
+            mMappedBegin = offset;
+            glBindBuffer(GL_COPY_WRITE_BUFFER, mId);
+            mMappedData = static_cast<unsigned char*>(glMapBufferRange(
+                GL_COPY_WRITE_BUFFER, mMappedBegin, regionBegin + mFrameSize - mMappedBegin,
+                GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                    GL_MAP_INVALIDATE_RANGE_BIT));
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+            if(!mMappedData) {
+                Log::error() << "Could not map streaming buffer!";
+                return {};
+            }
+        }
+        data = mMappedData + (offset - mMappedBegin);
+    }
+
+    mHead = offset + size - regionBegin;
+    return {data, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size)};
+}
+
+// Makes written data visible to the GPU
+void StreamingBuffer::flush() {
+    if(!mMappedData) {
+        return; // Persistent mappings are coherent
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mId);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    mMappedData = nullptr;
+}
+
+// Call once all commands reading this frame's data were issued
+void StreamingBuffer::endFrame() {
+    flush();
+
+    mFences[mCurrentFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    mCurrentFrame = (mCurrentFrame + 1) % FRAME_COUNT;
+    mHead = 0;
+    mOverflowed = false;
+
+    waitForFence(mCurrentFrame);
+}
+
+void StreamingBuffer::waitForFence(std::size_t frame) {
+    GLsync& fence = mFences[frame];
+    if(!fence) {
+        return;
+    }
+
+    // Usually already signaled, the GPU is rarely FRAME_COUNT frames behind
+    constexpr GLuint64 TIMEOUT_NS = 1000000; // 1 ms
+    GLbitfield flags = 0;
+    GLenum result;
+    while((result = glClientWaitSync(fence, flags, TIMEOUT_NS)) == GL_TIMEOUT_EXPIRED) {
+        flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    }
+
+    if(result == GL_WAIT_FAILED) {
+        Log::glError(glGetError()) << "Failed waiting on streaming buffer fence!";
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+// glBufferStorage is GL 4.4 (or ARB_buffer_storage), glad's core 4.3 header doesn't
+// have its flags
+#ifndef GL_MAP_PERSISTENT_BIT
+constexpr GLbitfield GL_MAP_PERSISTENT_BIT = 0x0040;
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+constexpr GLbitfield GL_MAP_COHERENT_BIT = 0x0080;
+#endif
+
+// Large ring buffer for data that changes every frame (skin palettes, debug
+// geometry, ...). The buffer is split in FRAME_COUNT regions, each frame writes
+// to its own region and a fence makes sure the GPU is done reading a region
+// before it is written again, so no allocation or implicit sync happens per upload.
+// Persistently mapped when glBufferStorage is available, otherwise each region is
+// mapped unsynchronized on demand.
+class StreamingBuffer {
+public:
+    static constexpr std::size_t FRAME_COUNT = 3;
+    using BufferStorageProc = void(APIENTRYP)(GLenum target, GLsizeiptr size,
+                                              const void* data, GLbitfield flags);
+
+    struct Allocation {
+        void* data = nullptr; // CPU pointer to write to
+        GLintptr offset = 0;  // Offset in the buffer, to bind or source from
+        GLsizeiptr size = 0;
+
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    explicit StreamingBuffer(std::size_t frameSize);
+    ~StreamingBuffer();
+    StreamingBuffer(const StreamingBuffer&) = delete;
+    StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+    Allocation allocate(std::size_t size, std::size_t alignment = 16);
+    template <typename T>
+    Allocation upload(const T* data, std::size_t count, std::size_t alignment = 16) {
+        Allocation allocation = allocate(count * sizeof(T), alignment);
+        if(allocation) {
+            std::memcpy(allocation.data, data, count * sizeof(T));
+        }
+        return allocation;
+    }
+    template <typename T>
+    Allocation upload(const std::vector<T>& data, std::size_t alignment = 16) {
+        return upload(data.data(), data.size(), alignment);
+    }
+
+    void flush();
+    void endFrame();
+
+    GLuint getId() const { return mId; }
+    std::size_t getUniformAlignment() const { return mUniformAlignment; }
+    std::size_t getStorageAlignment() const { return mStorageAlignment; }
+    bool isPersistent() const { return mPersistentData != nullptr; }
+    // Main thread. Null without GL 4.4 or ARB_buffer_storage.
+    static BufferStorageProc loadBufferStorage();
+
+private:
+    GLuint mId = 0;
+    std::size_t mFrameSize = 0;
+    std::size_t mUniformAlignment = 256;
+    std::size_t mStorageAlignment = 256;
+    std::size_t mCurrentFrame = 0;
+    std::size_t mHead = 0; // Write position in current frame region
+    bool mOverflowed = false;
+    std::array<GLsync, FRAME_COUNT> mFences{};
+
+    unsigned char* mPersistentData = nullptr;
+    unsigned char* mMappedData = nullptr; // Non-persistent fallback
+    std::size_t mMappedBegin = 0;
+
+    std::size_t getRegionBegin() const { return mCurrentFrame * mFrameSize; }
+    void waitForFence(std::size_t frame);
+};
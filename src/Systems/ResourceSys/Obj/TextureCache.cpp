@@ -0,0 +1,77 @@
+#include "TextureCache.hpp"
+
+#include "Log.hpp"
+#include "Utils/HashUtils.hpp"
+
+TextureCache& TextureCache::get() {
+    static std::unique_ptr<TextureCache> instance = std::make_unique<TextureCache>();
+    return *instance;
+}
+
+// Zero if a layer has no hash
+std::uint64_t TextureCache::getTextureArrayKey(
+    const std::vector<std::uint64_t>& layerHashes, std::uint64_t samplerKey) {
+    auto hashValue = [](std::uint64_t value, std::uint64_t hash) {
+        return Utils::hashBytes(reinterpret_cast<const unsigned char*>(&value),
+                                sizeof(value), hash);
+    };
+    std::uint64_t key = hashValue(samplerKey, Utils::FNV_OFFSET_BASIS);
+    for(std::uint64_t hash : layerHashes) {
+        if(!hash) return 0;
+        key = hashValue(hash, key);
+    }
+    return key;
+}
+
+bool TextureCache::containsImage(std::uint64_t hash) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mImages.find(hash);
+    if(it != mImages.end() && !it->second.expired()) return true;
+    auto layer = mLayerArrays.find(hash);
+    return layer != mLayerArrays.end() && !layer->second.expired();
+}
+
+ObjImage::Ptr TextureCache::findImage(std::uint64_t hash) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mImages.find(hash);
+    return it != mImages.end() ? it->second.lock() : nullptr;
+}
+
+void TextureCache::addImage(std::uint64_t hash, const ObjImage::Ptr& image) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::erase_if(mImages, [](const auto& entry) { return entry.second.expired(); });
+    mImages[hash] = image;
+}
+
+ObjTextureArray::Ptr TextureCache::findTextureArray(std::uint64_t key) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mTextureArrays.find(key);
+    return it != mTextureArrays.end() ? it->second.lock() : nullptr;
+}
+
+ObjTextureArray::Ptr TextureCache::findLayerArray(std::uint64_t hash) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mLayerArrays.find(hash);
+    return it != mLayerArrays.end() ? it->second.lock() : nullptr;
+}
+
+void TextureCache::addTextureArray(std::uint64_t key, const ObjTextureArray::Ptr& array,
+                                   const std::vector<std::uint64_t>& layerHashes) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto isExpired = [](const auto& entry) { return entry.second.expired(); };
+    std::erase_if(mTextureArrays, isExpired);
+    std::erase_if(mLayerArrays, isExpired);
+    mTextureArrays[key] = array;
+    for(std::uint64_t hash : layerHashes) mLayerArrays[hash] = array;
+}
+
+ObjSampler::CPtr TextureCache::getSampler(const ObjSampler::Parameters& parameters) {
+    std::weak_ptr<const ObjSampler>& entry = mSamplers[parameters.getKey()];
+    ObjSampler::CPtr sampler = entry.lock();
+    if(!sampler) {
+        sampler = ObjSampler::create(parameters);
+        entry = sampler;
+        Log::debug() << "Created sampler " << sampler->samplerId << ".";
+    }
+    return sampler;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ObjImage.hpp"
+#include "ObjSampler.hpp"
+#include "ObjTextureArray.hpp"
+
+// Shares images, texture arrays and samplers across every loaded resource. Images are
+// keyed by the hash of their encoded data, texture arrays by the hashes of their
+// layers and their sampler, samplers by their parameters. Entries only live as long
+// as a resource uses them.
+class TextureCache {
+public:
+    static TextureCache& get();
+    TextureCache() = default;
+
+    static std::uint64_t getTextureArrayKey(const std::vector<std::uint64_t>& layerHashes,
+                                            std::uint64_t samplerKey);
+
+    // Any thread, so decoding can be skipped. Layers of texture arrays count.
+    bool containsImage(std::uint64_t hash);
+    // Main thread. Null if no resource has the image anymore.
+    ObjImage::Ptr findImage(std::uint64_t hash);
+    void addImage(std::uint64_t hash, const ObjImage::Ptr& image); // Main thread
+    // Main thread. Null if no resource has the array anymore.
+    ObjTextureArray::Ptr findTextureArray(std::uint64_t key);
+    // Main thread. Any array with the image as a layer, null if none.
+    ObjTextureArray::Ptr findLayerArray(std::uint64_t hash);
+    void addTextureArray(std::uint64_t key, const ObjTextureArray::Ptr& array,
+                         const std::vector<std::uint64_t>& layerHashes); // Main thread
+    // Main thread. Created on first use.
+    ObjSampler::CPtr getSampler(const ObjSampler::Parameters& parameters);
+
+private:
+    std::mutex mMutex; // For images and arrays
+    std::unordered_map<std::uint64_t, std::weak_ptr<ObjImage>> mImages;
+    std::unordered_map<std::uint64_t, std::weak_ptr<ObjTextureArray>> mTextureArrays;
+    std::unordered_map<std::uint64_t, std::weak_ptr<ObjTextureArray>> mLayerArrays;
+    std::unordered_map<std::uint64_t, std::weak_ptr<const ObjSampler>> mSamplers;
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+};
@@ -0,0 +1,483 @@
+#include "TextureCompression.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "Constants.hpp"
+#include "Log.hpp"
+#include "Utils/FileUtils.hpp"
+#include "Utils/ImageUtils.hpp"
+#include "Utils/MappedFile.hpp"
+
+namespace TextureCompression {
+namespace {
+// S3TC is an extension, so glad's core 4.3 header doesn't have its enums
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+constexpr GLenum GL_COMPRESSED_RGB_S3TC_DXT1_EXT = 0x83F0;
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+constexpr GLenum GL_COMPRESSED_RGBA_S3TC_DXT5_EXT = 0x83F3;
+#endif
+
+constexpr char MAGIC[4] = {'V', 'T', 'E', 'X'};
+constexpr std::uint32_t VERSION = 1; // Bump on any layout or encoder change
+
+// Followed by the level entries, then the 16 byte aligned level data. Like KTX2,
+// without supercompression or the data format descriptor.
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t sourceHash;
+    std::uint32_t format;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t levelCount;
+};
+
+struct LevelEntry {
+    std::uint64_t offset; // From the start of the file
+    std::uint64_t size;
+};
+
+using Block = unsigned char[16][4]; // 4x4 RGBA texels, row by row
+
+std::uint16_t packColor(const int color[3]) {
+    int r = (color[0] * 31 + 127) / 255;
+    int g = (color[1] * 63 + 127) / 255;
+    int b = (color[2] * 31 + 127) / 255;
+    return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void unpackColor(std::uint16_t packed, int color[3]) {
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// BC1 color block, always in 4 color mode. Endpoints are the corners of the bounding
+// box along which the colors vary most, inset a bit.
+void encodeColorBlock(const Block& block, unsigned char* output) {
+    int minColor[3] = {255, 255, 255};
+    int maxColor[3] = {0, 0, 0};
+    int mean[3] = {0, 0, 0};
+    for(const auto& texel : block) {
+        for(int c = 0; c < 3; ++c) {
+            minColor[c] = std::min<int>(minColor[c], texel[c]);
+            maxColor[c] = std::max<int>(maxColor[c], texel[c]);
+            mean[c] += texel[c];
+        }
+    }
+
+    // Channels varying against the widest one take the other diagonal
+    int axis = 0;
+    for(int c = 1; c < 3; ++c) {
+        if(maxColor[c] - minColor[c] > maxColor[axis] - minColor[axis]) axis = c;
+    }
+    int covariance[3] = {0, 0, 0};
+    for(const auto& texel : block) {
+        int axisOffset = texel[axis] * 16 - mean[axis];
+        for(int c = 0; c < 3; ++c) {
+            covariance[c] += axisOffset * (texel[c] * 16 - mean[c]);
+        }
+    }
+
+    int endpoints[2][3];
+    for(int c = 0; c < 3; ++c) {
+        int inset = (maxColor[c] - minColor[c]) / 16;
+        int high = maxColor[c] - inset;
+        int low = minColor[c] + inset;
+        bool flip = covariance[c] < 0;
+        endpoints[0][c] = flip ? low : high;
+        endpoints[1][c] = flip ? high : low;
+    }
+
+    std::uint16_t color0 = packColor(endpoints[0]);
+    std::uint16_t color1 = packColor(endpoints[1]);
+    if(color0 < color1) std::swap(color0, color1);
+
+    std::uint32_t indices = 0;
+    if(color0 != color1) {
+        int palette[4][3];
+        unpackColor(color0, palette[0]);
+        unpackColor(color1, palette[1]);
+        for(int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for(int i = 0; i < 16; ++i) {
+            int bestIndex = 0;
+            int bestDistance = std::numeric_limits<int>::max();
+            for(int p = 0; p < 4; ++p) {
+                int distance = 0;
+                for(int c = 0; c < 3; ++c) {
+                    int difference = block[i][c] - palette[p][c];
+                    distance += difference * difference;
+                }
+                if(distance < bestDistance) {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+            indices |= static_cast<std::uint32_t>(bestIndex) << (2 * i);
+        }
+    }
+
+    std::memcpy(output, &color0, 2); // Little endian, like the format
+    std::memcpy(output + 2, &color1, 2);
+    std::memcpy(output + 4, &indices, 4);
+}
+
+// BC4 block of one channel, in 8 value mode
+void encodeChannelBlock(const Block& block, int channel, unsigned char* output) {
+    int minValue = 255;
+    int maxValue = 0;
+    for(const auto& texel : block) {
+        minValue = std::min<int>(minValue, texel[channel]);
+        maxValue = std::max<int>(maxValue, texel[channel]);
+    }
+
+    output[0] = static_cast<unsigned char>(maxValue);
+    output[1] = static_cast<unsigned char>(minValue);
+    std::uint64_t indices = 0;
+    if(maxValue != minValue) {
+        int palette[8] = {maxValue, minValue};
+        for(int p = 2; p < 8; ++p) {
+            palette[p] = ((8 - p) * maxValue + (p - 1) * minValue) / 7;
+        }
+
+        for(int i = 0; i < 16; ++i) {
+            int bestIndex = 0;
+            for(int p = 1; p < 8; ++p) {
+                if(std::abs(block[i][channel] - palette[p]) <
+                   std::abs(block[i][channel] - palette[bestIndex])) {
+                    bestIndex = p;
+                }
+            }
+            indices |= static_cast<std::uint64_t>(bestIndex) << (3 * i);
+        }
+    }
+
+    for(int i = 0; i < 6; ++i) {
+        output[2 + i] = static_cast<unsigned char>(indices >> (8 * i));
+    }
+}
+
+std::vector<unsigned char> encodeLevel(const std::vector<unsigned char>& pixels,
+                                       int width, int height, int components,
+                                       Format format) {
+    const int blockSize = format == Format::BC1 ? 8 : 16;
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    std::vector<unsigned char> output(static_cast<std::size_t>(blocksX) * blocksY *
+                                      blockSize);
+
+    unsigned char* blockOutput = output.data();
+    for(int blockY = 0; blockY < blocksY; ++blockY) {
+        for(int blockX = 0; blockX < blocksX; ++blockX) {
+            // Edge blocks repeat the last row and column
+            Block block;
+            for(int i = 0; i < 16; ++i) {
+                int x = std::min(blockX * 4 + i % 4, width - 1);
+                int y = std::min(blockY * 4 + i / 4, height - 1);
+                const unsigned char* texel =
+                    &pixels[(static_cast<std::size_t>(y) * width + x) * components];
+                for(int c = 0; c < 4; ++c) {
+                    block[i][c] = c < components ? texel[c] : 255;
+                }
+            }
+
+            switch(format) {
+                case Format::BC1:
+                    encodeColorBlock(block, blockOutput);
+                    break;
+                case Format::BC3:
+                    encodeChannelBlock(block, 3, blockOutput);
+                    encodeColorBlock(block, blockOutput + 8);
+                    break;
+                case Format::BC5:
+                    encodeChannelBlock(block, 0, blockOutput);
+                    encodeChannelBlock(block, 1, blockOutput + 8);
+                    break;
+            }
+            blockOutput += blockSize;
+        }
+    }
+    return output;
+}
+
+// BC1 color block, in 4 color mode if color0 > color1, else 3 colors and black
+void decodeColorBlock(const unsigned char* input, Block& block) {
+    std::uint16_t color0, color1;
+    std::uint32_t indices;
+    std::memcpy(&color0, input, 2);
+    std::memcpy(&color1, input + 2, 2);
+    std::memcpy(&indices, input + 4, 4);
+
+    int palette[4][3];
+    unpackColor(color0, palette[0]);
+    unpackColor(color1, palette[1]);
+    for(int c = 0; c < 3; ++c) {
+        if(color0 > color1) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+
+    for(int i = 0; i < 16; ++i) {
+        const int* color = palette[(indices >> (2 * i)) & 3];
+        for(int c = 0; c < 3; ++c) block[i][c] = static_cast<unsigned char>(color[c]);
+    }
+}
+
+// BC4 block, in 8 value mode if value0 > value1, else 6 values, 0 and 255
+void decodeChannelBlock(const unsigned char* input, int channel, Block& block) {
+    int palette[8] = {input[0], input[1]};
+    for(int p = 2; p < 8; ++p) {
+        if(palette[0] > palette[1]) {
+            palette[p] = ((8 - p) * palette[0] + (p - 1) * palette[1]) / 7;
+        } else if(p < 6) {
+            palette[p] = ((6 - p) * palette[0] + (p - 1) * palette[1]) / 5;
+        } else {
+            palette[p] = p == 6 ? 0 : 255;
+        }
+    }
+
+    std::uint64_t indices = 0;
+    for(int i = 0; i < 6; ++i) {
+        indices |= static_cast<std::uint64_t>(input[2 + i]) << (8 * i);
+    }
+    for(int i = 0; i < 16; ++i) {
+        block[i][channel] = static_cast<unsigned char>(palette[(indices >> (3 * i)) & 7]);
+    }
+}
+
+std::size_t alignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+GLenum getInternalFormat(Format format) {
+    switch(format) {
+        case Format::BC1:
+            return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case Format::BC3:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case Format::BC5:
+            return GL_COMPRESSED_RG_RGTC2;
+    }
+    return 0;
+}
+
+std::size_t getLevelSize(Format format, int width, int height) {
+    std::size_t blocks = static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4);
+    return blocks * (format == Format::BC1 ? 8 : 16);
+}
+
+// BC5 (RGTC) is core, BC1 and BC3 need S3TC
+bool isSupported() {
+    static const bool supported = [] {
+        if(!glGetStringi) return false; // No GL context, when baking
+
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for(GLint i = 0; i < extensionCount; ++i) {
+            const char* extension =
+                reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if(extension &&
+               std::strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0) {
+                return true;
+            }
+        }
+        Log::warn() << "S3TC is not supported, baked textures are ignored.";
+        return false;
+    }();
+    return supported;
+}
+
+Format chooseFormat(const std::vector<unsigned char>& pixels, int components,
+                    bool isNormalMap) {
+    if(isNormalMap) return Format::BC5;
+    if(components == 4) {
+        for(std::size_t i = 3; i < pixels.size(); i += 4) {
+            if(pixels[i] != 255) return Format::BC3;
+        }
+    }
+    return Format::BC1;
+}
+
+CompressedImage encode(const std::vector<unsigned char>& pixels, int width, int height,
+                       int components, Format format) {
+    CompressedImage image;
+    image.format = format;
+    image.width = width;
+    image.height = height;
+
+    // Levels back to back in data, viewed once it stops growing
+    std::vector<std::size_t> levelSizes;
+    auto addLevel = [&](const std::vector<unsigned char>& levelPixels) {
+        std::vector<unsigned char> encoded =
+            encodeLevel(levelPixels, width, height, components, format);
+        image.data.insert(image.data.end(), encoded.begin(), encoded.end());
+        levelSizes.push_back(encoded.size());
+    };
+
+    addLevel(pixels);
+    std::vector<unsigned char> level;
+    const std::vector<unsigned char>* previous = &pixels;
+    while(width > 1 || height > 1) {
+        level = Utils::halveImage(*previous, width, height, components);
+        addLevel(level);
+        previous = &level;
+    }
+
+    std::size_t offset = 0;
+    for(std::size_t size : levelSizes) {
+        image.levels.emplace_back(image.data.data() + offset, size);
+        offset += size;
+    }
+    return image;
+}
+
+std::vector<unsigned char> decodeLevel(std::span<const unsigned char> level,
+                                       Format format, int width, int height) {
+    const int blockSize = format == Format::BC1 ? 8 : 16;
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    std::vector<unsigned char> pixels(static_cast<std::size_t>(width) * height * 4);
+    if(level.size() < static_cast<std::size_t>(blocksX) * blocksY * blockSize) {
+        return pixels;
+    }
+
+    const unsigned char* blockInput = level.data();
+    for(int blockY = 0; blockY < blocksY; ++blockY) {
+        for(int blockX = 0; blockX < blocksX; ++blockX) {
+            Block block = {};
+            switch(format) {
+                case Format::BC1:
+                    decodeColorBlock(blockInput, block);
+                    break;
+                case Format::BC3:
+                    decodeChannelBlock(blockInput, 3, block);
+                    decodeColorBlock(blockInput + 8, block);
+                    break;
+                case Format::BC5:
+                    decodeChannelBlock(blockInput, 0, block);
+                    decodeChannelBlock(blockInput + 8, 1, block);
+                    break;
+            }
+            if(format != Format::BC3) {
+                for(auto& texel : block) texel[3] = 255;
+            }
+
+            // Edge blocks cover texels past the image
+            for(int i = 0; i < 16; ++i) {
+                int x = blockX * 4 + i % 4;
+                int y = blockY * 4 + i / 4;
+                if(x >= width || y >= height) continue;
+                std::memcpy(&pixels[(static_cast<std::size_t>(y) * width + x) * 4],
+                            block[i], 4);
+            }
+            blockInput += blockSize;
+        }
+    }
+    return pixels;
+}
+
+std::filesystem::path getCachePath(std::uint64_t sourceHash) {
+    std::ostringstream name;
+    name << std::hex << sourceHash << ".vtex";
+    return std::filesystem::path(Constants::MESH_CACHE_DIR) / name.str();
+}
+
+bool read(const std::filesystem::path& path, std::uint64_t sourceHash,
+          CompressedImage& image) {
+    auto mappedFile = std::make_shared<const Utils::MappedFile>(path);
+    const Utils::MappedFile& file = *mappedFile;
+    if(!file.isOpen()) return false;
+
+    Header header;
+    if(file.getSize() < sizeof(Header)) return false;
+    std::memcpy(&header, file.getData(), sizeof(Header));
+    if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+       header.version != VERSION || header.sourceHash != sourceHash ||
+       header.format > static_cast<std::uint32_t>(Format::BC5)) {
+        Log::debug() << "Ignoring outdated baked texture '" << path.string() << "'.";
+        return false;
+    }
+
+    image.format = static_cast<Format>(header.format);
+    image.width = static_cast<int>(header.width);
+    image.height = static_cast<int>(header.height);
+    const std::size_t levelCount =
+        std::bit_width(std::max(header.width, header.height));
+    if(header.levelCount != levelCount ||
+       file.getSize() < sizeof(Header) + levelCount * sizeof(LevelEntry)) {
+        Log::warn() << "Baked texture '" << path.string() << "' is corrupt.";
+        return false;
+    }
+
+    image.levels.resize(levelCount);
+    image.data.clear();
+    for(std::size_t i = 0; i < levelCount; ++i) {
+        LevelEntry entry;
+        std::memcpy(&entry, file.getData() + sizeof(Header) + i * sizeof(LevelEntry),
+                    sizeof(LevelEntry));
+        std::size_t expectedSize = getLevelSize(
+            image.format, std::max(image.width >> i, 1), std::max(image.height >> i, 1));
+        if(entry.size != expectedSize || entry.offset + entry.size > file.getSize()) {
+            Log::warn() << "Baked texture '" << path.string() << "' is corrupt.";
+            image.levels.clear(); // Would outlive the mapping
+            return false;
+        }
+        image.levels[i] = {file.getData() + entry.offset, entry.size};
+    }
+    image.file = std::move(mappedFile);
+    return true;
+}
+
+bool write(const std::filesystem::path& path, std::uint64_t sourceHash,
+           const CompressedImage& image) {
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.sourceHash = sourceHash;
+    header.format = static_cast<std::uint32_t>(image.format);
+    header.width = static_cast<std::uint32_t>(image.width);
+    header.height = static_cast<std::uint32_t>(image.height);
+    header.levelCount = static_cast<std::uint32_t>(image.levels.size());
+
+    std::vector<LevelEntry> entries;
+    std::size_t offset = sizeof(Header) + image.levels.size() * sizeof(LevelEntry);
+    for(const auto& level : image.levels) {
+        offset = alignUp(offset, 16);
+        entries.push_back({offset, level.size()});
+        offset += level.size();
+    }
+
+    return Utils::writeFileAtomically(path, [&](std::ofstream& file) {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char*>(entries.data()),
+                   static_cast<std::streamsize>(entries.size() * sizeof(LevelEntry)));
+        for(std::size_t i = 0; i < image.levels.size(); ++i) {
+            static const char PADDING[16] = {};
+            file.write(PADDING, static_cast<std::streamsize>(entries[i].offset -
+                                                              file.tellp()));
+            file.write(reinterpret_cast<const char*>(image.levels[i].data()),
+                       static_cast<std::streamsize>(image.levels[i].size()));
+        }
+    });
+}
+} // namespace TextureCompression
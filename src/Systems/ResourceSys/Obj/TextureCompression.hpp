@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Utils/MappedFile.hpp"
+
+// Block compressed textures, encoded offline by the -t bake step and stored in the
+// cache dir with their mip chain. Baked files are named after the hash of the
+// encoded source image (PNG, JPEG, ...), like MeshCache files.
+namespace TextureCompression {
+enum class Format : std::uint32_t {
+    BC1, // RGB, 4 bits per texel
+    BC3, // RGBA, 8 bits per texel
+    BC5, // Two channel normal maps, 8 bits per texel
+};
+
+// Levels point into the mapped baked file when read, else into data. Not copyable,
+// the levels would still point into the original.
+struct CompressedImage {
+    Format format = Format::BC1;
+    int width = 0;
+    int height = 0;
+    std::vector<std::span<const unsigned char>> levels; // Finest first, down to 1x1
+    std::vector<unsigned char> data;                    // Every level, if encoded
+    std::shared_ptr<const Utils::MappedFile> file;      // If read
+
+    CompressedImage() = default;
+    CompressedImage(CompressedImage&&) = default;
+    CompressedImage& operator=(CompressedImage&&) = default;
+    CompressedImage(const CompressedImage&) = delete;
+    CompressedImage& operator=(const CompressedImage&) = delete;
+};
+
+GLenum getInternalFormat(Format format);
+std::size_t getLevelSize(Format format, int width, int height);
+// Main thread. False without a GL context, or without S3TC support.
+bool isSupported();
+
+// BC5 for normal maps, BC3 if any texel is translucent, else BC1
+Format chooseFormat(const std::vector<unsigned char>& pixels, int components,
+                    bool isNormalMap);
+// Encodes every mip level of tightly packed 8 bit RGB or RGBA pixels
+CompressedImage encode(const std::vector<unsigned char>& pixels, int width, int height,
+                       int components, Format format);
+// Back to RGBA pixels, following the format specs rather than the encoder, to check
+// it. BC5 decodes to red and green, with blue 0 and alpha 255.
+std::vector<unsigned char> decodeLevel(std::span<const unsigned char> level,
+                                       Format format, int width, int height);
+
+std::filesystem::path getCachePath(std::uint64_t sourceHash);
+// False on missing, outdated or corrupt files. The file stays mapped for as long as
+// the image lives.
+bool read(const std::filesystem::path& path, std::uint64_t sourceHash,
+          CompressedImage& image);
+bool write(const std::filesystem::path& path, std::uint64_t sourceHash,
+           const CompressedImage& image);
+} // namespace TextureCompression
@@ -0,0 +1,199 @@
+#include "TextureStreamer.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "Log.hpp"
+#include "TextureUploader.hpp"
+#include "Utils/ImageUtils.hpp"
+
+namespace {
+// Bytes of the mip chain from level on, assuming 4 bytes per uncompressed texel on
+// the GPU
+std::size_t getChainMemory(const ObjImage& image, int level) {
+    const auto& compressed = image.residency.compressedSource;
+    std::size_t memory = 0;
+    for(int i = level; i < image.getLevelCount(); ++i) {
+        int width = std::max(image.width >> i, 1);
+        int height = std::max(image.height >> i, 1);
+        memory += compressed ? TextureCompression::getLevelSize(compressed->format,
+                                                                width, height)
+                             : static_cast<std::size_t>(width) * height * 4;
+    }
+    return memory;
+}
+
+// Level with at most the initial size
+int getInitialLevel(const ObjImage& image) {
+    int level = 0;
+    while(std::max(image.width >> level, image.height >> level) >
+          static_cast<int>(Constants::TEXTURE_STREAMING_INITIAL_SIZE)) {
+        ++level;
+    }
+    return level;
+}
+} // namespace
+
+TextureStreamer& TextureStreamer::get() {
+    static std::unique_ptr<TextureStreamer> instance =
+        std::make_unique<TextureStreamer>();
+    return *instance;
+}
+
+// The downsampling jobs queue to the uploader, which must outlive them
+TextureStreamer::TextureStreamer() { TextureUploader::get(); }
+
+void TextureStreamer::add(const ObjImage::Ptr& image, std::vector<unsigned char> pixels,
+                          int components) {
+    ObjImage::Residency& residency = image->residency;
+    residency.sourcePixels =
+        std::make_shared<const std::vector<unsigned char>>(std::move(pixels));
+    residency.components = components;
+    residency.internalFormat = (components == 3) ? GL_RGB8 : GL_RGBA8;
+    track(image);
+}
+
+void TextureStreamer::add(
+    const ObjImage::Ptr& image,
+    std::shared_ptr<const TextureCompression::CompressedImage> compressed) {
+    ObjImage::Residency& residency = image->residency;
+    residency.internalFormat = TextureCompression::getInternalFormat(compressed->format);
+    residency.compressedSource = std::move(compressed);
+    track(image);
+}
+
+void TextureStreamer::track(const ObjImage::Ptr& image) {
+    image->residency.residentLevel = image->getLevelCount(); // Nothing yet
+    image->residency.lastUse = mFrameIndex;
+    mImages.push_back(image);
+    loadLevel(image, getInitialLevel(*image));
+}
+
+void TextureStreamer::request(ObjImage& image, float screenSize) {
+    if(!image.residency.sourcePixels && !image.residency.compressedSource) {
+        return; // Not streamed
+    }
+
+    // One texel per pixel at the requested level
+    float texels = static_cast<float>(std::max(image.width, image.height));
+    int level = screenSize > 0.0f ? static_cast<int>(std::log2(texels / screenSize)) : 0;
+    level = std::clamp(level, 0, image.getLevelCount() - 1);
+
+    ObjImage::Residency& residency = image.residency;
+    if(residency.requestedLevel < 0 || level < residency.requestedLevel) {
+        residency.requestedLevel = level;
+    }
+    residency.lastUse = mFrameIndex;
+}
+
+void TextureStreamer::update(std::size_t budget) {
+    struct Target {
+        ObjImage::Ptr image;
+        int level;
+    };
+
+    // Drawn images want their requested level, the others keep what they have
+    std::vector<Target> targets;
+    std::size_t residentMemory = 0;
+    std::size_t targetMemory = 0;
+    std::erase_if(mImages, [](const auto& image) { return image.expired(); });
+    for(const auto& weakImage : mImages) {
+        ObjImage::Ptr image = weakImage.lock();
+        ObjImage::Residency& residency = image->residency;
+        int level = residency.requestedLevel >= 0 ? residency.requestedLevel
+                                                  : residency.residentLevel;
+        residency.requestedLevel = -1;
+
+        residentMemory += getChainMemory(*image, residency.residentLevel);
+        targetMemory += getChainMemory(*image, level);
+        targets.push_back({std::move(image), level});
+    }
+
+    // Past the budget, least recently used images give up their finest levels first
+    bool overBudget = std::max(residentMemory, targetMemory) > budget;
+    std::sort(targets.begin(), targets.end(), [](const Target& a, const Target& b) {
+        return a.image->residency.lastUse < b.image->residency.lastUse;
+    });
+    for(Target& target : targets) {
+        while(targetMemory > budget && target.level < target.image->getLevelCount() - 1) {
+            targetMemory -= getChainMemory(*target.image, target.level) -
+                            getChainMemory(*target.image, target.level + 1);
+            ++target.level;
+        }
+    }
+
+    // Levels which are no longer needed are only dropped to make room
+    for(Target& target : targets) {
+        ObjImage::Residency& residency = target.image->residency;
+        if(target.level < residency.residentLevel && !residency.loading) {
+            loadLevel(target.image, target.level);
+        } else if(target.level > residency.residentLevel && overBudget) {
+            residentMemory -= getChainMemory(*target.image, residency.residentLevel) -
+                              getChainMemory(*target.image, target.level);
+            dropLevels(*target.image, target.level);
+        }
+    }
+
+    mResidentMemory = residentMemory;
+    ++mFrameIndex;
+}
+
+void TextureStreamer::flush() {
+    mDownsamplers.wait();
+    TextureUploader::get().flush();
+}
+
+// Downsamples the source on the worker thread, then queues the upload. Baked levels
+// are queued right away.
+void TextureStreamer::loadLevel(const ObjImage::Ptr& image, int level) {
+    ObjImage::Residency& residency = image->residency;
+    residency.loading = true;
+    if(residency.compressedSource) {
+        TextureUploader::get().queue(image, residency.compressedSource, level);
+        return;
+    }
+    mDownsamplers.submit([weakImage = std::weak_ptr<ObjImage>(image),
+                          source = residency.sourcePixels, width = image->width,
+                          height = image->height, components = residency.components,
+                          level]() mutable {
+        std::vector<unsigned char> pixels;
+        if(level > 0) {
+            pixels = Utils::halveImage(*source, width, height, components);
+            for(int i = 1; i < level; ++i) {
+                pixels = Utils::halveImage(pixels, width, height, components);
+            }
+        } else {
+            pixels = *source;
+        }
+        TextureUploader::get().queue(std::move(weakImage), std::move(pixels),
+                                     std::max(width >> level, 1),
+                                     std::max(height >> level, 1), components, level);
+    });
+}
+
+// Copies the coarser levels into a smaller texture, on the GPU
+void TextureStreamer::dropLevels(ObjImage& image, int level) {
+    const int droppedLevels = level - image.residency.residentLevel;
+    const int levelCount = image.getLevelCount() - level;
+    const int width = std::max(image.width >> level, 1);
+    const int height = std::max(image.height >> level, 1);
+
+    GLuint texId;
+    glGenTextures(1, &texId);
+    glBindTexture(GL_TEXTURE_2D, texId);
+    glTexStorage2D(GL_TEXTURE_2D, levelCount, image.residency.internalFormat, width,
+                   height);
+    for(int i = 0; i < levelCount; ++i) {
+        glCopyImageSubData(image.textureId, GL_TEXTURE_2D, i + droppedLevels, 0, 0, 0,
+                           texId, GL_TEXTURE_2D, i, 0, 0, 0, std::max(width >> i, 1),
+                           std::max(height >> i, 1), 1);
+    }
+
+    Log::debug() << "Dropped " << droppedLevels << " mip levels of image '" << image.name
+                 << "'.";
+    glDeleteTextures(1, &image.textureId);
+    image.textureId = texId;
+    image.residency.residentLevel = level;
+}
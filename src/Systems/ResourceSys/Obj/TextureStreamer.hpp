@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Constants.hpp"
+#include "ObjImage.hpp"
+#include "TextureCompression.hpp"
+#include "Utils/ThreadPool.hpp"
+
+// Keeps only the mip levels images need on the GPU, under a memory budget.
+// Draws request the level matching their size on screen, finer levels are
+// downsampled from the kept source pixels on a worker thread and uploaded through
+// the TextureUploader. Past the budget, the least recently used images lose their
+// finest levels first.
+class TextureStreamer {
+public:
+    static TextureStreamer& get();
+    TextureStreamer();
+
+    // Main thread. Keeps the pixels as the source of every level, and starts with a
+    // coarse one until draws ask for more.
+    void add(const ObjImage::Ptr& image, std::vector<unsigned char> pixels,
+             int components);
+    // Same with baked levels, which are uploaded as they are
+    void add(const ObjImage::Ptr& image,
+             std::shared_ptr<const TextureCompression::CompressedImage> compressed);
+    // Main thread, for each draw sampling the image. screenSize is the height in
+    // pixels the image is stretched over.
+    void request(ObjImage& image, float screenSize);
+    // Main thread, once per frame after the draws
+    void update(std::size_t budget = Constants::TEXTURE_GPU_MEMORY_BUDGET);
+    void flush(); // Main thread, finishes the levels being loaded
+    std::size_t getResidentMemory() const { return mResidentMemory; }
+
+private:
+    std::vector<std::weak_ptr<ObjImage>> mImages;
+    std::uint64_t mFrameIndex = 0;
+    std::size_t mResidentMemory = 0; // As of the last update
+    Utils::ThreadPool mDownsamplers{1};
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    void track(const ObjImage::Ptr& image);
+    void loadLevel(const ObjImage::Ptr& image, int level);
+    void dropLevels(ObjImage& image, int level);
+};
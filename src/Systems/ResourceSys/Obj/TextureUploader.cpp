@@ -0,0 +1,409 @@
+#include "TextureUploader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+#include "Log.hpp"
+#include "StreamingBuffer.hpp"
+#include "Utils/ImageUtils.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+constexpr std::size_t RING_ALIGNMENT = 16;
+
+double getMilliseconds(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::size_t alignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+TextureUploader& TextureUploader::get() {
+    static std::unique_ptr<TextureUploader> instance =
+        std::make_unique<TextureUploader>();
+    return *instance;
+}
+
+TextureUploader::~TextureUploader() {
+    mStagers.wait();
+    for(Region& region : mRegions) {
+        if(region.fence) glDeleteSync(region.fence);
+    }
+    if(mRingData) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mPixelBuffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &mPixelBuffer);
+}
+
+void TextureUploader::queue(std::weak_ptr<ObjImage> image,
+                            std::vector<unsigned char> pixels, int width, int height,
+                            int components, int level) {
+    PendingUpload upload;
+    upload.image = std::move(image);
+    upload.level = level;
+    upload.width = width;
+    upload.height = height;
+    upload.components = components;
+    upload.mips.push_back(std::move(pixels));
+    prepare(std::move(upload));
+}
+
+void TextureUploader::queue(
+    std::weak_ptr<ObjImage> image,
+    std::shared_ptr<const TextureCompression::CompressedImage> compressed, int level) {
+    PendingUpload upload;
+    upload.image = std::move(image);
+    upload.level = level;
+    upload.width = std::max(compressed->width >> level, 1);
+    upload.height = std::max(compressed->height >> level, 1);
+    upload.compressed = std::move(compressed);
+    prepare(std::move(upload));
+}
+
+void TextureUploader::queue(const ObjTextureArray::Ptr& array, int layer,
+                            std::vector<unsigned char> pixels) {
+    PendingUpload upload;
+    upload.array = array;
+    upload.layer = layer;
+    upload.width = array->width;
+    upload.height = array->height;
+    upload.mips.push_back(std::move(pixels));
+    prepare(std::move(upload));
+}
+
+void TextureUploader::queue(
+    const ObjTextureArray::Ptr& array, int layer,
+    std::shared_ptr<const TextureCompression::CompressedImage> compressed) {
+    PendingUpload upload;
+    upload.array = array;
+    upload.layer = layer;
+    upload.width = compressed->width;
+    upload.height = compressed->height;
+    upload.compressed = std::move(compressed);
+    prepare(std::move(upload));
+}
+
+void TextureUploader::update(double budgetMs) {
+    Clock::time_point start = Clock::now();
+    bool hasRoom = false;
+    if(!mRingCreated) {
+        createRing();
+        hasRoom = true;
+    }
+
+    // Uploads waiting for room try again once some was freed
+    if(releaseRegions(false) || hasRoom) {
+        std::vector<PendingUpload> waitingUploads;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            waitingUploads.swap(mWaitingUploads);
+        }
+        for(PendingUpload& waiting : waitingUploads) prepare(std::move(waiting));
+    }
+
+    PendingUpload pending;
+    while(getMilliseconds(start) < budgetMs && popReadyUpload(pending)) {
+        upload(pending);
+    }
+}
+
+void TextureUploader::flush() {
+    while(true) {
+        mStagers.wait();
+        update(std::numeric_limits<double>::infinity());
+        if(getPendingCount() == 0) break;
+
+        // Waiting for room, or for uploads prepared on other threads
+        if(!releaseRegions(true)) std::this_thread::yield();
+    }
+}
+
+std::size_t TextureUploader::getPendingCount() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mReadyUploads.size() + mWaitingUploads.size() + mPreparingCount;
+}
+
+// Stages right away on pool threads (decoders, downsamplers), else on mStagers, so
+// the main thread never touches the pixels
+void TextureUploader::prepare(PendingUpload upload) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mPreparingCount;
+    }
+
+    if(Utils::ThreadPool::isWorkerThread()) {
+        stage(upload);
+    } else {
+        auto shared = std::make_shared<PendingUpload>(std::move(upload));
+        mStagers.submit([this, shared]() { stage(*shared); });
+    }
+}
+
+// Any thread. Builds the mip chain, then copies every level into the ring. Uploads
+// waiting for room keep their levels for the next try.
+void TextureUploader::stage(PendingUpload& upload) {
+    if(upload.levelSizes.empty()) {
+        bool isValid = true;
+        if(upload.compressed) {
+            const auto& levels = upload.compressed->levels;
+            isValid = upload.level < static_cast<int>(levels.size());
+            for(std::size_t i = upload.level; isValid && i < levels.size(); ++i) {
+                upload.levelSizes.push_back(levels[i].size());
+            }
+        } else {
+            isValid = upload.width > 0 && upload.height > 0 &&
+                      upload.mips.front().size() >=
+                          static_cast<std::size_t>(upload.width) * upload.height *
+                              upload.components;
+            int width = upload.width;
+            int height = upload.height;
+            while(isValid && (width > 1 || height > 1)) {
+                upload.mips.push_back(Utils::halveImage(upload.mips.back(), width,
+                                                        height, upload.components));
+            }
+            for(const auto& mip : upload.mips) upload.levelSizes.push_back(mip.size());
+        }
+
+        if(!isValid) {
+            Log::error() << "Invalid pixel data for a texture upload!";
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mPreparingCount;
+            return;
+        }
+    }
+
+    std::size_t size = 0;
+    for(std::size_t levelSize : upload.levelSizes) size += levelSize;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        bool fitsRing = mRingData && size <= Constants::TEXTURE_UPLOAD_BUFFER_SIZE;
+        if(!mRingCreated || (fitsRing && !allocate(size, upload.offset))) {
+            mWaitingUploads.push_back(std::move(upload));
+            --mPreparingCount;
+            return;
+        }
+        upload.isStaged = fitsRing;
+    }
+
+    // The region is ours until its upload is fenced, no need to hold the lock
+    if(upload.isStaged) {
+        unsigned char* data = mRingData + upload.offset;
+        for(std::size_t i = 0; i < upload.levelSizes.size(); ++i) {
+            const unsigned char* source =
+                upload.compressed ? upload.compressed->levels[upload.level + i].data()
+                                  : upload.mips[i].data();
+            std::memcpy(data, source, upload.levelSizes[i]);
+            data += upload.levelSizes[i];
+        }
+        upload.mips.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mReadyUploads.push(std::move(upload));
+    --mPreparingCount;
+}
+
+// mMutex held. Regions are handed out in ring order, so the free space is after the
+// newest region and before the oldest one.
+bool TextureUploader::allocate(std::size_t size, std::size_t& offset) {
+    if(mRegions.empty()) mRingHead = 0;
+    const std::size_t tail = mRegions.empty() ? 0 : mRegions.front().begin;
+    std::size_t begin = alignUp(mRingHead, RING_ALIGNMENT);
+
+    if(mRegions.empty() || mRingHead > tail) {
+        if(begin + size > Constants::TEXTURE_UPLOAD_BUFFER_SIZE) {
+            if(size > tail) return false;
+            begin = 0; // Wraps around
+        }
+    } else if(begin + size > tail) {
+        return false;
+    }
+
+    mRegions.push_back({begin, begin + size, nullptr});
+    mRingHead = begin + size;
+    offset = begin;
+    return true;
+}
+
+// Main thread
+void TextureUploader::createRing() {
+    const auto size = static_cast<GLsizeiptr>(Constants::TEXTURE_UPLOAD_BUFFER_SIZE);
+    unsigned char* data = nullptr;
+    if(StreamingBuffer::BufferStorageProc bufferStorage =
+           StreamingBuffer::loadBufferStorage()) {
+        const GLbitfield flags =
+            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &mPixelBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mPixelBuffer);
+        bufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, flags);
+        data = static_cast<unsigned char*>(
+            glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    Log::debug() << (data ? "Created" : "Cannot create") << " texture upload ring of "
+                 << size << " bytes.";
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRingData = data;
+    mRingCreated = true;
+}
+
+// Main thread. Frees the ring space of uploads the GPU is done with, waiting for it
+// if asked to. True if any was freed.
+bool TextureUploader::releaseRegions(bool wait) {
+    constexpr GLuint64 TIMEOUT_NS = 1000000; // 1 ms
+    std::lock_guard<std::mutex> lock(mMutex);
+    bool released = false;
+    while(!mRegions.empty() && mRegions.front().fence) {
+        GLsync fence = mRegions.front().fence;
+        GLenum result = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                         wait ? TIMEOUT_NS : 0);
+        if(result == GL_TIMEOUT_EXPIRED) {
+            if(wait) continue;
+            break;
+        }
+        if(result == GL_WAIT_FAILED) {
+            Log::glError(glGetError()) << "Failed waiting on texture upload fence!";
+        }
+
+        glDeleteSync(fence);
+        mRegions.pop_front();
+        released = true;
+    }
+    return released;
+}
+
+bool TextureUploader::popReadyUpload(PendingUpload& upload) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(mReadyUploads.empty()) return false;
+
+    upload = std::move(mReadyUploads.front());
+    mReadyUploads.pop();
+    return true;
+}
+
+// Main thread. Only issues the copies, which read the ring asynchronously on the GPU.
+void TextureUploader::upload(PendingUpload& upload) {
+    if(upload.isStaged) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mPixelBuffer);
+    if(ObjImage::Ptr image = upload.image.lock()) {
+        uploadImage(*image, upload);
+    } else if(ObjTextureArray::Ptr array = upload.array.lock()) {
+        uploadLayer(*array, upload);
+    }
+    if(!upload.isStaged) return;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    std::lock_guard<std::mutex> lock(mMutex);
+    for(Region& region : mRegions) {
+        if(region.begin == upload.offset && !region.fence) {
+            region.fence = fence;
+            break;
+        }
+    }
+}
+
+void TextureUploader::uploadImage(ObjImage& image, const PendingUpload& upload) {
+    const int levelCount = static_cast<int>(upload.levelSizes.size());
+    if(levelCount != image.getLevelCount() - upload.level) {
+        Log::error() << "Invalid mip levels for image '" << image.name << "'!";
+        return;
+    }
+
+    GLuint texId;
+    glGenTextures(1, &texId);
+    glBindTexture(GL_TEXTURE_2D, texId);
+
+    // Immutable storage with the rest of the mip chain
+    GLenum internalFormat = (upload.components == 3) ? GL_RGB8 : GL_RGBA8;
+    if(upload.compressed) {
+        internalFormat = TextureCompression::getInternalFormat(upload.compressed->format);
+    }
+    GLenum format = (upload.components == 3) ? GL_RGB : GL_RGBA;
+    glTexStorage2D(GL_TEXTURE_2D, levelCount, internalFormat, upload.width,
+                   upload.height);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // RGB rows aren't 4 byte aligned
+    std::size_t offset = 0;
+    for(int i = 0; i < levelCount; ++i) {
+        const int width = std::max(upload.width >> i, 1);
+        const int height = std::max(upload.height >> i, 1);
+        const void* data = getLevelData(upload, i, offset);
+        if(upload.compressed) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, width, height,
+                                      internalFormat,
+                                      static_cast<GLsizei>(upload.levelSizes[i]), data);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, width, height, format,
+                            GL_UNSIGNED_BYTE, data);
+        }
+        offset += upload.levelSizes[i];
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    replaceTexture(image, texId, upload.level);
+}
+
+void TextureUploader::replaceTexture(ObjImage& image, GLuint texId, int level) {
+    GLenum error = glGetError();
+    if(error != GL_NO_ERROR) {
+        Log::error() << "OpenGL error: " << error;
+    }
+
+    glDeleteTextures(1, &image.textureId); // Coarser levels, if any
+    image.textureId = texId;
+    image.residency.residentLevel = level;
+    image.residency.loading = false;
+}
+
+void TextureUploader::uploadLayer(ObjTextureArray& array, const PendingUpload& upload) {
+    const int levelCount = static_cast<int>(upload.levelSizes.size());
+    if(levelCount != array.getLevelCount() || upload.width != array.width ||
+       upload.height != array.height) {
+        Log::error() << "Invalid data for layer " << upload.layer
+                     << " of a texture array!";
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array.textureId);
+    std::size_t offset = 0;
+    for(int i = 0; i < levelCount; ++i) {
+        const int width = std::max(array.width >> i, 1);
+        const int height = std::max(array.height >> i, 1);
+        const void* data = getLevelData(upload, i, offset);
+        if(upload.compressed) {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, upload.layer, width,
+                                      height, 1, array.internalFormat,
+                                      static_cast<GLsizei>(upload.levelSizes[i]), data);
+        } else {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, upload.layer, width, height, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, data);
+        }
+        offset += upload.levelSizes[i];
+    }
+
+    ++array.uploadedLayers;
+    GLenum error = glGetError();
+    if(error != GL_NO_ERROR) {
+        Log::error() << "OpenGL error: " << error;
+    }
+}
+
+// Level index of the upload, for the texture copies. Staged levels are at offset from
+// the start of the upload in the bound ring.
+const void* TextureUploader::getLevelData(const PendingUpload& upload, int index,
+                                          std::size_t offset) const {
+    if(upload.isStaged) {
+        return reinterpret_cast<const void*>(upload.offset + offset);
+    }
+    if(upload.compressed) {
+        return upload.compressed->levels[upload.level + index].data();
+    }
+    return upload.mips[index].data();
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "Constants.hpp"
+#include "ObjImage.hpp"
+#include "ObjTextureArray.hpp"
+#include "TextureCompression.hpp"
+#include "Utils/ThreadPool.hpp"
+
+// Uploads decoded images a few per frame, so loading assets mid-game doesn't stall
+// rendering. Images have no texture until their upload is done, and are rendered
+// without it until then. The texture is replaced on each upload, see TextureStreamer.
+//
+// Pixels and their mip chain are prepared off the main thread and written straight
+// into a persistently mapped pixel buffer ring. The main thread only issues the
+// texture copies, and fences which free ring space once the GPU is done with it.
+// Without glBufferStorage, or when an upload doesn't fit the ring, the texture copies
+// read from client memory instead.
+class TextureUploader {
+public:
+    static TextureUploader& get();
+    TextureUploader() = default;
+    ~TextureUploader();
+
+    // Any thread. Pixels are of the given mip level (of width x height texels),
+    // tightly packed, 8 bits per component. The texture gets that level and the
+    // coarser ones.
+    void queue(std::weak_ptr<ObjImage> image, std::vector<unsigned char> pixels,
+               int width, int height, int components, int level = 0);
+    // Same with the baked levels from level on
+    void queue(std::weak_ptr<ObjImage> image,
+               std::shared_ptr<const TextureCompression::CompressedImage> compressed,
+               int level);
+    // Same for a whole layer of a texture array, from RGBA pixels or baked levels
+    void queue(const ObjTextureArray::Ptr& array, int layer,
+               std::vector<unsigned char> pixels);
+    void queue(const ObjTextureArray::Ptr& array, int layer,
+               std::shared_ptr<const TextureCompression::CompressedImage> compressed);
+    // Main thread, once per frame. Uploads prepared images while the time budget
+    // lasts, checked before each upload.
+    void update(double budgetMs = Constants::TEXTURE_UPLOAD_BUDGET_MS);
+    void flush(); // Main thread, uploads everything queued
+    std::size_t getPendingCount();
+
+private:
+    struct PendingUpload {
+        std::weak_ptr<ObjImage> image;        // Skipped if evicted in the meantime
+        std::weak_ptr<ObjTextureArray> array; // Instead of the image
+        int layer = 0;
+        int level = 0;  // Image level of the first uploaded level
+        int width = 0;  // Of the first uploaded level
+        int height = 0;
+        int components = 4;
+        std::shared_ptr<const TextureCompression::CompressedImage> compressed;
+        std::vector<std::vector<unsigned char>> mips; // If not compressed or staged
+        std::vector<std::size_t> levelSizes;          // Of each uploaded level
+        std::size_t offset = 0;                       // In the ring, once staged
+        bool isStaged = false;
+    };
+
+    // Ring space of a staged upload, freed once its fence is signaled
+    struct Region {
+        std::size_t begin;
+        std::size_t end;
+        GLsync fence;
+    };
+
+    std::mutex mMutex;
+    std::queue<PendingUpload> mReadyUploads;    // Staged or read from client memory
+    std::vector<PendingUpload> mWaitingUploads; // For ring space
+    std::size_t mPreparingCount = 0;            // Queued but not ready yet
+
+    bool mRingCreated = false; // On the first update
+    GLuint mPixelBuffer = 0;
+    unsigned char* mRingData = nullptr; // Persistently mapped, null if unavailable
+    std::size_t mRingHead = 0;
+    std::deque<Region> mRegions; // Oldest first
+
+    // Last, as its jobs use the rest
+    Utils::ThreadPool mStagers{1};
+
+    TextureUploader(const TextureUploader&) = delete;
+    TextureUploader& operator=(const TextureUploader&) = delete;
+
+    void prepare(PendingUpload upload);
+    void stage(PendingUpload& upload);
+    bool allocate(std::size_t size, std::size_t& offset);
+    void createRing();
+    bool releaseRegions(bool wait);
+    bool popReadyUpload(PendingUpload& upload);
+    void upload(PendingUpload& upload);
+    void uploadImage(ObjImage& image, const PendingUpload& upload);
+    void uploadLayer(ObjTextureArray& array, const PendingUpload& upload);
+    void replaceTexture(ObjImage& image, GLuint texId, int level);
+    const void* getLevelData(const PendingUpload& upload, int index,
+                             std::size_t offset) const;
+};
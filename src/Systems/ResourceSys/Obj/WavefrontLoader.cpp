@@ -2,152 +2,223 @@
 
 #include <glad/glad.h>
 
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <limits>
 #include <utility>
 
+#include "Constants.hpp"
 #include "Log.hpp"
-#include "ObjMaterial.hpp"
-#include "ObjResource.hpp"
+#include "Utils/HashUtils.hpp"
+
+namespace {
+// Deduplicates vertices by value, using an open addressing hash table of indices
+// into the output vertices. Sized upfront to stay at most half full, so it never
+// rehashes.
+class VertexWelder {
+public:
+    VertexWelder(std::size_t maxVertexCount, std::vector<ObjResource::Vertex>& vertices)
+        : mSlots(std::bit_ceil(maxVertexCount * 2 + 1), EMPTY_SLOT),
+          mMask(mSlots.size() - 1), mVertices(vertices) {
+        mVertices.clear();
+        mVertices.reserve(maxVertexCount);
+    }
+
+    // Index of the vertex, added if new
+    unsigned int weld(ObjResource::Vertex vertex) {
+        // -0 and 0 compare equal, so they must hash the same
+        vertex.position += glm::vec3(0.0f);
+        vertex.normal += glm::vec3(0.0f);
+        vertex.texcoord += glm::vec2(0.0f);
+
+        std::size_t slot = hash(vertex) & mMask;
+        while(mSlots[slot] != EMPTY_SLOT) {
+            const ObjResource::Vertex& other = mVertices[mSlots[slot]];
+            if(other.position == vertex.position && other.normal == vertex.normal &&
+               other.texcoord == vertex.texcoord &&
+               other.materialId == vertex.materialId) {
+                return mSlots[slot];
+            }
+            slot = (slot + 1) & mMask;
+        }
+
+        mSlots[slot] = static_cast<unsigned int>(mVertices.size());
+        mVertices.push_back(vertex);
+        return mSlots[slot];
+    }
+
+private:
+    static constexpr unsigned int EMPTY_SLOT = std::numeric_limits<unsigned int>::max();
+    static constexpr std::size_t KEY_SIZE = offsetof(ObjResource::Vertex, joints);
+    static_assert(KEY_SIZE ==
+                      sizeof(glm::vec3) * 2 + sizeof(glm::vec2) + sizeof(unsigned int),
+                  "Vertex attributes must be tightly packed to be hashed");
+
+    std::vector<unsigned int> mSlots;
+    std::size_t mMask;
+    std::vector<ObjResource::Vertex>& mVertices;
+
+    static std::uint64_t hash(const ObjResource::Vertex& vertex) {
+        std::uint64_t hash =
+            Utils::hashBytes(reinterpret_cast<const unsigned char*>(&vertex), KEY_SIZE);
+        return hash ^ (hash >> 32); // FNV's low bits are weak
+    }
+};
+} // namespace
 
-WavefrontLoader::WavefrontLoader(const std::filesystem::path& path) : mPath(path) {
+WavefrontLoader::WavefrontLoader(const std::filesystem::path& path, AssetPack::CPtr pack)
+    : mPath(path), mPack(std::move(pack)) {
     Log::debug() << "Creating WavefrontLoader for '" << mPath.string() << "'.";
 }
 
-bool WavefrontLoader::load(ObjResource& resource) {
-    // https://github.com/tinyobjloader/tinyobjloader?tab=readme-ov-file
-    tinyobj::ObjReader reader;
-    tinyobj::ObjReaderConfig reader_config;
-    reader_config.triangulate = true;
-
-    if(!reader.ParseFromFile(mPath.string(), reader_config)) {
-        if(!reader.Error().empty()) {
-            Log::error() << "TinyObjReader error while loading '" << mPath.string()
-                         << "': " << reader.Error();
-            return false;
+bool WavefrontLoader::parse() {
+    std::uint64_t sourceHash = 0;
+    std::filesystem::path cachePath;
+    if(Constants::ENABLE_MESH_CACHE) {
+        sourceHash = MeshCache::hashSource(mPath, mPack.get());
+        cachePath = MeshCache::getCachePath(sourceHash);
+        if(sourceHash != 0 && MeshCache::read(cachePath, sourceHash, mCached)) {
+            Log::debug() << "Loaded '" << mPath.string() << "' from mesh cache '"
+                         << cachePath.string() << "'.";
+            return true;
         }
     }
 
-    if(!reader.Warning().empty()) {
-        Log::warn() << "TinyObjReader warning while loading '" << mPath.string()
-                    << "': " << reader.Warning();
+    ObjParser parser;
+    if(!parser.parse(mPath, mPack.get())) return false;
+    Log::debug() << "Parsed '" << mPath.string() << "' in " << parser.getChunkCount()
+                 << " chunks.";
+
+    parseMeshes(parser);
+    parseMaterials(parser);
+    calculateBounds();
+
+    if(Constants::ENABLE_MESH_CACHE && sourceHash != 0 &&
+       MeshCache::write(cachePath, sourceHash, mParsed)) {
+        Log::debug() << "Wrote mesh cache '" << cachePath.string() << "'.";
+    }
+    return true;
+}
+
+bool WavefrontLoader::upload(ObjResource& resource) {
+    if(mCached.file) {
+        uploadCached(resource);
+        return true;
     }
 
-    loadOnGPU(resource, reader);
+    for(MeshCache::Mesh& mesh : mParsed.meshes) {
+        resource.objMeshes.emplace_back(
+            ObjMesh::create(resource, mesh.name, std::move(mesh.indices)));
+    }
+    mParsed.meshes.clear();
+
+    // Load interleaved attributes and materials
+    resource.vertexBuffer.setData(GL_ARRAY_BUFFER, mParsed.vertices);
+    resource.vertices = std::move(mParsed.vertices);
+    resource.materialUniformBuffer.setData(GL_UNIFORM_BUFFER, mParsed.materials);
+    resource.boundingBox = ObjBoundingBox::create(mParsed.minCorner, mParsed.maxCorner);
     return true;
 }
 
-void WavefrontLoader::loadOnGPU(ObjResource& resource, const tinyobj::ObjReader& reader) {
-    loadMeshes(resource, reader);
+// Straight from the mapping of the cache file, which is closed once uploaded
+void WavefrontLoader::uploadCached(ObjResource& resource) {
+    for(const MeshCache::MappedContents::Mesh& mesh : mCached.meshes) {
+        resource.objMeshes.emplace_back(
+            ObjMesh::create(resource, mesh.name, mesh.indices));
+    }
+    resource.vertexBuffer.setData(GL_ARRAY_BUFFER, mCached.vertices);
+    resource.materialUniformBuffer.setData(GL_UNIFORM_BUFFER, mCached.materials);
+    resource.boundingBox = ObjBoundingBox::create(mCached.minCorner, mCached.maxCorner);
+    mCached = {};
+}
 
+void WavefrontLoader::parseMaterials(const ObjParser& parser) {
     // Convert OBJ materials to PBR-compatible format
-    std::vector<ObjMaterial> objMaterials;
-    for(const tinyobj::material_t& objMat : reader.GetMaterials()) {
+    for(const ObjParser::Material& objMat : parser.getMaterials()) {
         ObjMaterial mat = {};
 
         // Convert diffuse to baseColor
-        mat.baseColor =
-            glm::vec3(objMat.diffuse[0], objMat.diffuse[1], objMat.diffuse[2]);
+        mat.baseColor = objMat.diffuse;
         mat.alpha = 1.0f - objMat.dissolve; // OBJ uses "dissolve" for transparency
 
         // Convert specular to roughness/metallic approximation
-        mat.metallic = glm::length(glm::vec3(objMat.specular[0], objMat.specular[1],
-                                             objMat.specular[2])) *
-                       0.40;
+        mat.metallic = glm::length(objMat.specular) * 0.40;
         mat.roughness = 1.0f - objMat.shininess / 500.0f; // Roughness approximation
 
         // Emission (same in both OBJ & PBR)
-        mat.emission =
-            glm::vec3(objMat.emission[0], objMat.emission[1], objMat.emission[2]);
+        mat.emission = objMat.emission;
 
-        objMaterials.push_back(mat);
+        mParsed.materials.push_back(mat);
     }
 
-    // Upload materials to GPU
-    resource.materialUniformBuffer.setData(GL_UNIFORM_BUFFER, objMaterials);
-    Log::debug() << "Loaded " << objMaterials.size() << " materials.";
+    Log::debug() << "Loaded " << mParsed.materials.size() << " materials.";
 }
 
-void WavefrontLoader::loadMeshes(ObjResource& resource,
-                                 const tinyobj::ObjReader& reader) {
+// We are given per-vertex attributes (position, normal, texcoords) indexed separately,
+// and per-FACE material ids (sad!). OpenGL wants a single index buffer, so every
+// face corner becomes a full vertex with the material of its face, and identical
+// vertices are welded back together.
+void WavefrontLoader::parseMeshes(const ObjParser& parser) {
     const unsigned VERTICES_PER_FACE = 3;
-    const glm::vec3 UNINITIALIZED_VEC3(-1.0f);
-    const glm::vec2 UNINITIALIZED_VEC2(-1.0f);
-
-    // We are given per-vertex attributes (position, normal, texcoords, colors),
-    // and per-FACE material id (sad!). This does not work well with OpenGL
-    // index buffers. To fix this, we make the material id per-VERTEX. To do this,
-    // we find any vertex which is used by faces with different material ids, and
-    // duplicate it. This ensures every face is composed of 3 vertices with the
-    // same material id, greatly simplifying the rendering process.
-
-    // Copy all attributes :(
-    // NOTE: We convert all attributes to only use a single index buffer (vertex index).
-    // -1 to identify uninitialized values.
-    const auto& attribs = reader.GetAttrib();
-    std::vector<ObjResource::Vertex> outVertices(
-        attribs.vertices.size() / 3,
-        ObjResource::Vertex{UNINITIALIZED_VEC3, UNINITIALIZED_VEC3, UNINITIALIZED_VEC2,
-                            0});
-
-    Log::debug() << "Found " << attribs.vertices.size() << " vertex positions, "
-                 << attribs.normals.size() << " normals and " << attribs.texcoords.size()
+
+    const auto& positions = parser.getPositions();
+    const auto& normals = parser.getNormals();
+    const auto& texcoords = parser.getTexcoords();
+    const auto& shapes = parser.getShapes();
+    Log::debug() << "Found " << positions.size() << " vertex positions, "
+                 << normals.size() << " normals and " << texcoords.size()
                  << " texcoords.";
 
-    for(const auto& shape : reader.GetShapes()) {
+    std::size_t cornerCount = 0;
+    for(const auto& shape : shapes) cornerCount += shape.indices.size();
+    VertexWelder welder(cornerCount, mParsed.vertices);
+
+    for(const auto& shape : shapes) {
         std::vector<unsigned int> meshVertexIndices;
-        meshVertexIndices.reserve(shape.mesh.indices.size());
-        size_t originalVertexCount = attribs.vertices.size() / VERTICES_PER_FACE;
-        size_t duplicatedVertices = 0; // For logs
+        meshVertexIndices.reserve(shape.indices.size());
         Log::debug() << "Loading mesh '" << shape.name << "' with "
-                     << shape.mesh.indices.size() / VERTICES_PER_FACE << " faces.";
-
-        for(size_t indexI = 0; indexI < shape.mesh.indices.size(); ++indexI) {
-            int vertexI = shape.mesh.indices[indexI].vertex_index;
-            int normalI = shape.mesh.indices[indexI].normal_index;
-            int texcoordI = shape.mesh.indices[indexI].texcoord_index;
-
-            glm::vec3 newVertex(attribs.vertices[vertexI * 3],
-                                attribs.vertices[vertexI * 3 + 1],
-                                attribs.vertices[vertexI * 3 + 2]);
-            glm::vec3 newNormal = normalI >= 0
-                                      ? glm::vec3(attribs.normals[normalI * 3],
-                                                  attribs.normals[normalI * 3 + 1],
-                                                  attribs.normals[normalI * 3 + 2])
-                                      : glm::vec3(0.0f);
-            glm::vec2 newTexcoord = texcoordI >= 0
-                                        ? glm::vec2(attribs.texcoords[texcoordI * 2],
-                                                    attribs.texcoords[texcoordI * 2 + 1])
-                                        : glm::vec2(0.0f);
-            GLuint newMaterialId = shape.mesh.material_ids[indexI / VERTICES_PER_FACE];
-
-            if((outVertices[vertexI].normal != UNINITIALIZED_VEC3 &&
-                outVertices[vertexI].normal != newNormal) ||
-               (outVertices[vertexI].texcoord != UNINITIALIZED_VEC2 &&
-                outVertices[vertexI].texcoord != newTexcoord) ||
-               (outVertices[vertexI].materialId != -1 &&
-                outVertices[vertexI].materialId != newMaterialId)) {
-                // Bummer! A previous vertex set the attributes of this vertex.
-                // We must duplicate it.
-                outVertices.push_back(outVertices[vertexI]);
-                ++duplicatedVertices;
-            }
+                     << shape.indices.size() / VERTICES_PER_FACE << " faces.";
+
+        for(size_t indexI = 0; indexI < shape.indices.size(); ++indexI) {
+            const ObjParser::Index& index = shape.indices[indexI];
 
-            // Move attributes
-            outVertices[vertexI] = {newVertex, newNormal, newTexcoord, newMaterialId};
+            ObjResource::Vertex vertex{};
+            vertex.position = positions[index.position];
+            if(index.normal >= 0) vertex.normal = normals[index.normal];
+            if(index.texcoord >= 0) vertex.texcoord = texcoords[index.texcoord];
+            vertex.materialId = shape.materialIds[indexI / VERTICES_PER_FACE];
 
-            // Copy our vertex index
-            meshVertexIndices.emplace_back(vertexI);
+            meshVertexIndices.push_back(welder.weld(vertex));
         }
 
         // Add mesh
-        resource.objMeshes.emplace_back(
-            ObjMesh::create(resource, shape.name, meshVertexIndices));
-        Log::debug() << "Duplicated " << duplicatedVertices << " vertices for mesh '"
-                     << shape.name << "' (originally had " << originalVertexCount
-                     << " vertices).";
+        mParsed.meshes.push_back({shape.name, std::move(meshVertexIndices)});
     }
 
-    // Load interleaved attributes
-    resource.vertexBuffer.setData(GL_ARRAY_BUFFER, outVertices);
-    resource.vertices = std::move(outVertices);
+    Log::info() << "Welded " << cornerCount << " face corners of '" << mPath.string()
+                << "' (" << positions.size() << " positions) into "
+                << mParsed.vertices.size() << " vertices.";
+}
+
+// Same as ObjBoundingBox, meshes have no transform
+void WavefrontLoader::calculateBounds() {
+    mParsed.minCorner = glm::vec3(std::numeric_limits<float>::max());
+    mParsed.maxCorner = glm::vec3(std::numeric_limits<float>::lowest());
+
+    bool empty = true;
+    for(const MeshCache::Mesh& mesh : mParsed.meshes) {
+        for(unsigned int index : mesh.indices) {
+            const glm::vec3& position = mParsed.vertices[index].position;
+            mParsed.minCorner = glm::min(mParsed.minCorner, position);
+            mParsed.maxCorner = glm::max(mParsed.maxCorner, position);
+            empty = false;
+        }
+    }
+
+    if(empty) {
+        Log::error() << "No points to calculate bounding box.";
+        mParsed.minCorner = mParsed.maxCorner = glm::vec3(0.0f);
+    }
 }
@@ -1,19 +1,27 @@
 #pragma once
 
-#include <tiny_obj_loader.h>
-
 #include <filesystem>
 
+#include "MeshCache.hpp"
 #include "ObjLoader.hpp"
+#include "ObjParser.hpp"
+#include "Systems/ResourceSys/AssetPack.hpp"
 
-class ObjResource;
 class WavefrontLoader : public ObjLoader {
 public:
-    WavefrontLoader(const std::filesystem::path& path);
-    bool load(ObjResource& resource) override final;
+    // Reads from the pack if given
+    WavefrontLoader(const std::filesystem::path& path, AssetPack::CPtr pack = nullptr);
+    bool parse() override final;
+    bool upload(ObjResource& resource) override final;
 
 private:
     const std::filesystem::path mPath;
-    void loadOnGPU(ObjResource& resource, const tinyobj::ObjReader& reader);
-    void loadMeshes(ObjResource& resource, const tinyobj::ObjReader& reader);
+    AssetPack::CPtr mPack;
+    MeshCache::Contents mParsed;       // Waiting for upload
+    MeshCache::MappedContents mCached; // Or, if read from the mesh cache
+
+    void parseMaterials(const ObjParser& parser);
+    void parseMeshes(const ObjParser& parser);
+    void calculateBounds();
+    void uploadCached(ObjResource& resource);
 };
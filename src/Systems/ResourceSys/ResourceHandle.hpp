@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+// Index of a scanned resource in ResourceSys, resolved once from its name so lookups
+// on the hot path are array accesses. The generation invalidates handles of a
+// previous scan. Default constructed handles are invalid.
+template <typename Resource>
+class ResourceHandle {
+public:
+    ResourceHandle() = default;
+
+    explicit operator bool() const { return mGeneration != 0; }
+    bool operator==(const ResourceHandle& other) const = default;
+
+    std::uint32_t getIndex() const { return mIndex; }
+    std::uint32_t getGeneration() const { return mGeneration; }
+
+private:
+    friend class ResourceSys;
+
+    ResourceHandle(std::uint32_t index, std::uint32_t generation)
+        : mIndex(index), mGeneration(generation) {}
+
+    std::uint32_t mIndex = 0;
+    std::uint32_t mGeneration = 0; // Scan generations start at 1
+};
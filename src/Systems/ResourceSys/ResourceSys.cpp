@@ -1,74 +1,265 @@
 #include "ResourceSys.hpp"
 
+#include <chrono>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <system_error>
+#include <utility>
 
 #include "Constants.hpp"
 #include "Log.hpp"
 #include "Obj/GltfLoader.hpp"
+#include "Obj/TextureStreamer.hpp"
 #include "Obj/WavefrontLoader.hpp"
 
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double getMilliseconds(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void logLoadTimes(const std::string& name, double parseTime, double uploadTime) {
+    Log::info() << "Loaded resource '" << name << "' (parse: " << parseTime
+                << " ms, upload: " << uploadTime << " ms).";
+}
+
+template <typename Entries>
+void addMemoryUsage(const Entries& entries, std::size_t& cpuUsage,
+                    std::size_t& gpuUsage) {
+    for(const auto& entry : entries) {
+        if(!entry.resource) continue;
+        cpuUsage += entry.cpuMemoryUsage;
+        gpuUsage += entry.gpuMemoryUsage;
+    }
+}
+
+// Least recently used loaded resource which only the cache owns, or nullptr
+template <typename Entries>
+typename Entries::pointer findEvictable(Entries& entries) {
+    typename Entries::pointer evictable = nullptr;
+    for(auto& entry : entries) {
+        if(!entry.resource || entry.resource.use_count() > 1) continue;
+        if(!evictable || entry.lastUse < evictable->lastUse) {
+            evictable = &entry;
+        }
+    }
+    return evictable;
+}
+
+template <typename Entry>
+void evict(Entry& entry, std::size_t& cpuUsage, std::size_t& gpuUsage) {
+    Log::info() << "Evicting resource '" << entry.name << "' ("
+                << (entry.cpuMemoryUsage + entry.gpuMemoryUsage) / 1024 << " KiB).";
+    cpuUsage -= entry.cpuMemoryUsage;
+    gpuUsage -= entry.gpuMemoryUsage;
+    entry.resource = nullptr;
+}
+} // namespace
+
 // Static
 ResourceSys& ResourceSys::get() {
     static std::unique_ptr<ResourceSys> instance = std::make_unique<ResourceSys>();
     return *instance;
 }
 
-// Will load all resources in all subdirs of the resource dir.
-// Resources will have the name of the file (without extension).
-bool ResourceSys::loadResources() {
-    Log::info() << "Loading resources from " << Constants::RESOURCE_DIR
-                << "/ directory...";
-    bool res = loadResourcesFromDir(Constants::RESOURCE_DIR);
-    Log::info() << "Done loading resources!";
+// Registers all resources in all subdirs of the resource dir (or in the asset pack if
+// there is one), without loading them.
+// Resources will have the name of the file (without extension), and are loaded on
+// first use or by preloadResources(). Rescanning invalidates all handles.
+bool ResourceSys::scanResources() {
+    bool res = true;
+    ++mScanGeneration;
+    mObjResources = {};
+    mShaderResources = {};
+    mAudioResources = {};
+    if(std::filesystem::exists(Constants::RESOURCE_PACK_PATH)) {
+        Log::info() << "Scanning resources in asset pack "
+                    << Constants::RESOURCE_PACK_PATH << "...";
+        mAssetPack = AssetPack::create(Constants::RESOURCE_PACK_PATH);
+        if(!mAssetPack->isOpen()) return false;
+
+        for(const std::filesystem::path& path : mAssetPack->getPaths()) {
+            res &= scanResource(path);
+        }
+    } else {
+        Log::info() << "Scanning resources in " << Constants::RESOURCE_DIR
+                    << "/ directory...";
+        mAssetPack = nullptr; // Loaders would still read a pack that is gone
+        res = scanResourcesInDir(Constants::RESOURCE_DIR);
+    }
+    Log::info() << "Found " << mObjResources.entries.size() << " object, "
+                << mShaderResources.entries.size() << " shader and "
+                << mAudioResources.entries.size() << " audio resources.";
 
     return res;
 }
 
+// Loads the named resources (of any type) ahead of use. Files are parsed and decoded
+// on a thread pool, while the main thread (which owns the GL context) uploads them as
+// they are ready.
+bool ResourceSys::preloadResources(const std::vector<std::string>& names) {
+    Clock::time_point start = Clock::now();
+    Utils::ThreadPool threadPool;
+    bool success = true;
+
+    for(const std::string& name : names) {
+        bool found = false;
+        if(auto it = mObjResources.indices.find(name);
+           it != mObjResources.indices.end()) {
+            found = true;
+            if(!mObjResources.entries[it->second].resource) {
+                LoadJob job = createObjLoadJob(it->second);
+                parseInBackground(threadPool, name, std::move(job.parse),
+                                  std::move(job.upload));
+            }
+        }
+        if(auto it = mAudioResources.indices.find(name);
+           it != mAudioResources.indices.end()) {
+            found = true;
+            if(!mAudioResources.entries[it->second].resource) {
+                LoadJob job = createAudioLoadJob(it->second);
+                parseInBackground(threadPool, name, std::move(job.parse),
+                                  std::move(job.upload));
+            }
+        }
+        // Programs are compiled on the main thread, while the others are parsed
+        if(auto it = mShaderResources.indices.find(name);
+           it != mShaderResources.indices.end()) {
+            found = true;
+            if(!mShaderResources.entries[it->second].resource) {
+                queueUpload(name, createShaderLoadJob(it->second).upload);
+            }
+        }
+
+        if(!found) {
+            Log::error() << "Cannot preload unknown resource '" << name << "'!";
+            success = false;
+        }
+    }
+
+    success &= runUploads();
+    TextureStreamer::get().flush(); // Preloaded textures are ready for the first frame
+    enforceMemoryBudget();
+    Log::info() << "Preloaded " << names.size() << " resources in "
+                << getMilliseconds(start) << " ms (" << threadPool.getThreadCount()
+                << " loading threads).";
+
+    return success;
+}
+
+ObjResource::Handle ResourceSys::findObjResource(const std::string& name) const {
+    ObjResource::Handle handle = mObjResources.find(name);
+    if(!handle) Log::error() << "Cannot find obj resource '" << name << "'!";
+    return handle;
+}
+
+ShaderResource::Handle ResourceSys::findShaderResource(const std::string& name) const {
+    ShaderResource::Handle handle = mShaderResources.find(name);
+    if(!handle) Log::error() << "Cannot find shader resource '" << name << "'!";
+    return handle;
+}
+
+AudioResource::Handle ResourceSys::findAudioResource(const std::string& name) const {
+    AudioResource::Handle handle = mAudioResources.find(name);
+    if(!handle) Log::error() << "Cannot find audio resource '" << name << "'!";
+    return handle;
+}
+
+ObjResource::Ptr ResourceSys::getObjResource(ObjResource::Handle handle) {
+    Entry<ObjResource>* entry = mObjResources.get(handle);
+    if(!entry) return nullptr;
+
+    entry->lastUse = ++mUseCounter;
+    if(entry->resource) return entry->resource;
+
+    if(!load(entry->name, createObjLoadJob(handle.getIndex()))) return nullptr;
+    ObjResource::Ptr resource = entry->resource; // Now owned outside, can't be evicted
+    enforceMemoryBudget();
+    return resource;
+}
+
+ShaderResource::CPtr ResourceSys::getShaderResource(ShaderResource::Handle handle) {
+    Entry<ShaderResource>* entry = mShaderResources.get(handle);
+    if(!entry) return nullptr;
+
+    // Shaders are small, and never evicted
+    if(!entry->resource && !load(entry->name, createShaderLoadJob(handle.getIndex()))) {
+        return nullptr;
+    }
+    return entry->resource;
+}
+
+AudioResource::Ptr ResourceSys::getAudioResource(AudioResource::Handle handle) {
+    Entry<AudioResource>* entry = mAudioResources.get(handle);
+    if(!entry) return nullptr;
+
+    entry->lastUse = ++mUseCounter;
+    if(entry->resource) return entry->resource;
+
+    if(!load(entry->name, createAudioLoadJob(handle.getIndex()))) return nullptr;
+    AudioResource::Ptr resource = entry->resource; // Now owned outside, can't be evicted
+    enforceMemoryBudget();
+    return resource;
+}
+
 ObjResource::Ptr ResourceSys::getObjResource(const std::string& name) {
-    if(mObjResources.find(name) == mObjResources.end()) {
-        Log::error() << "Cannot find obj resource '" << name << "'!";
+    ObjResource::Handle handle = findObjResource(name);
+    if(!handle) {
         throw std::invalid_argument("No obj resource with name '" + name + "'");
     }
 
-    return mObjResources.at(name);
+    ObjResource::Ptr resource = getObjResource(handle);
+    if(!resource) {
+        throw std::runtime_error("Failed to load obj resource '" + name + "'");
+    }
+    return resource;
 }
 
-ShaderResource::CPtr ResourceSys::getShaderResource(const std::string& name) const {
-    if(mShaderResources.find(name) == mShaderResources.end()) {
-        Log::error() << "Cannot find shader resource '" << name << "'!";
+ShaderResource::CPtr ResourceSys::getShaderResource(const std::string& name) {
+    ShaderResource::Handle handle = findShaderResource(name);
+    if(!handle) {
         throw std::invalid_argument("No shader resource with name '" + name + "'");
     }
 
-    return mShaderResources.at(name);
+    ShaderResource::CPtr resource = getShaderResource(handle);
+    if(!resource) {
+        throw std::runtime_error("Failed to load shader resource '" + name + "'");
+    }
+    return resource;
 }
 
 AudioResource::Ptr ResourceSys::getAudioResource(const std::string& name) {
-    if(mAudioResources.find(name) == mAudioResources.end()) {
-        Log::error() << "Cannot find audio resource '" << name << "'!";
+    AudioResource::Handle handle = findAudioResource(name);
+    if(!handle) {
         throw std::invalid_argument("No audio resource with name '" + name + "'");
     }
 
-    return mAudioResources.at(name);
+    AudioResource::Ptr resource = getAudioResource(handle);
+    if(!resource) {
+        throw std::runtime_error("Failed to load audio resource '" + name + "'");
+    }
+    return resource;
 }
 
-bool ResourceSys::loadResourcesFromDir(const std::filesystem::path& dirPath) {
+bool ResourceSys::scanResourcesInDir(const std::filesystem::path& dirPath) {
     namespace fs = std::filesystem;
     bool success = true;
 
     if(!fs::is_directory(dirPath)) return false;
     for(const auto& entry : fs::directory_iterator(dirPath)) {
         if(fs::is_directory(entry.path())) {
-            success &= loadResourcesFromDir(entry.path());
+            success &= scanResourcesInDir(entry.path());
         } else {
-            success &= loadResource(entry.path());
+            success &= scanResource(entry.path());
         }
     }
 
     return success;
 }
 
-bool ResourceSys::loadResource(const std::filesystem::path& path) {
+bool ResourceSys::scanResource(const std::filesystem::path& path) {
     std::string name = path.stem().string();
     std::string type = path.extension().string();
 
@@ -82,39 +273,36 @@ bool ResourceSys::loadResource(const std::filesystem::path& path) {
     bool alreadyExists = false;
     std::string resourceType;
     if(type == ".obj" || type == ".gltf" || type == ".glb") {
-        if(mObjResources.find(name) != mObjResources.end()) {
+        if(mObjResources.contains(name)) {
             alreadyExists = true;
             resourceType = "object";
         } else {
-            if(type == ".obj") {
-                mObjResources.insert(
-                    {name, ObjResource::create(std::make_unique<WavefrontLoader>(path))});
-            } else {
-                mObjResources.insert(
-                    {name, ObjResource::create(std::make_unique<GltfLoader>(path))});
-            }
+            mObjResources.add(name, {path}, mScanGeneration);
         }
     } else if(type == ".wav" || type == ".flac" || type == ".mp3") {
-        if(mAudioResources.find(name) != mAudioResources.end()) {
+        if(mAudioResources.contains(name)) {
             alreadyExists = true;
             resourceType = "audio";
         } else {
-            mAudioResources.insert({name, AudioResource::create(path)});
+            mAudioResources.add(name, {path}, mScanGeneration);
         }
     } else if(type == ".glsl") {
-        if(mShaderResources.find(name) == mShaderResources.end()) {
+        if(!mShaderResources.contains(name)) {
             // Don't throw error, since multiple shader sources must have the same name.
-            // Find both vertex and fragment shader sources:
+            // Find both vertex and fragment shader sources, or a compute shader:
             std::filesystem::path vertexShaderPath =
                 path.parent_path() / (name + ".v.glsl");
             std::filesystem::path fragmentShaderPath =
                 path.parent_path() / (name + ".f.glsl");
+            std::filesystem::path computeShaderPath =
+                path.parent_path() / (name + ".c.glsl");
 
-            if(std::filesystem::exists(vertexShaderPath) &&
-               std::filesystem::exists(fragmentShaderPath)) {
-                mShaderResources.insert(
-                    {name,
-                     ShaderResource::create(name, vertexShaderPath, fragmentShaderPath)});
+            if(resourceFileExists(computeShaderPath)) {
+                mShaderResources.add(name, {computeShaderPath}, mScanGeneration);
+            } else if(resourceFileExists(vertexShaderPath) &&
+                      resourceFileExists(fragmentShaderPath)) {
+                mShaderResources.add(name, {vertexShaderPath, fragmentShaderPath},
+                                     mScanGeneration);
             } else {
                 Log::error() << "Failed to load shader '" << path.string() << "': "
                              << "could not find matching vertex/fragment shader!";
@@ -131,3 +319,179 @@ bool ResourceSys::loadResource(const std::filesystem::path& path) {
     }
     return true;
 }
+
+ResourceSys::LoadJob ResourceSys::createObjLoadJob(std::uint32_t index) {
+    const std::filesystem::path& path = mObjResources.entries[index].paths.front();
+
+    std::shared_ptr<ObjLoader> loader;
+    if(path.extension() == ".obj") {
+        loader = std::make_shared<WavefrontLoader>(path, mAssetPack);
+    } else {
+        loader = std::make_shared<GltfLoader>(path, mAssetPack);
+    }
+
+    return {[loader] { return loader->parse(); },
+            [this, index, loader] {
+                Entry<ObjResource>& entry = mObjResources.entries[index];
+                entry.resource = ObjResource::create(*loader);
+                entry.cpuMemoryUsage = entry.resource->getCPUMemoryUsage();
+                entry.gpuMemoryUsage = entry.resource->getGPUMemoryUsage();
+                entry.lastUse = ++mUseCounter;
+                return true;
+            }};
+}
+
+ResourceSys::LoadJob ResourceSys::createShaderLoadJob(std::uint32_t index) {
+    return {nullptr, [this, index] {
+                Entry<ShaderResource>& entry = mShaderResources.entries[index];
+                if(entry.paths.size() == 1) {
+                    entry.resource = ShaderResource::create(entry.name, entry.paths[0],
+                                                            mAssetPack.get());
+                } else {
+                    entry.resource =
+                        ShaderResource::create(entry.name, entry.paths[0], entry.paths[1],
+                                               mAssetPack.get());
+                }
+                return true;
+            }};
+}
+
+// Nothing to upload, the sound is decoded by miniaudio during parsing
+ResourceSys::LoadJob ResourceSys::createAudioLoadJob(std::uint32_t index) {
+    const std::filesystem::path& path = mAudioResources.entries[index].paths.front();
+    auto resource = std::make_shared<AudioResource::Ptr>();
+
+    return {[resource, path, pack = mAssetPack] {
+                *resource = AudioResource::create(path, pack);
+                return true;
+            },
+            [this, index, resource, path] {
+                Entry<AudioResource>& entry = mAudioResources.entries[index];
+                entry.resource = std::move(*resource);
+                std::error_code error;
+                std::uintmax_t fileSize =
+                    mAssetPack ? mAssetPack->getFile(path).size()
+                               : std::filesystem::file_size(path, error);
+                entry.cpuMemoryUsage = error ? 0 : static_cast<std::size_t>(fileSize);
+                entry.lastUse = ++mUseCounter;
+                return true;
+            }};
+}
+
+bool ResourceSys::resourceFileExists(const std::filesystem::path& path) const {
+    return mAssetPack ? mAssetPack->contains(path) : std::filesystem::exists(path);
+}
+
+// Loads on the calling thread
+bool ResourceSys::load(const std::string& name, LoadJob job) {
+    Clock::time_point start = Clock::now();
+    if(job.parse && !job.parse()) {
+        Log::error() << "Failed to parse resource '" << name << "'!";
+        return false;
+    }
+    double parseTime = getMilliseconds(start);
+
+    start = Clock::now();
+    bool uploaded = job.upload();
+    logLoadTimes(name, parseTime, getMilliseconds(start));
+    return uploaded;
+}
+
+void ResourceSys::parseInBackground(Utils::ThreadPool& threadPool,
+                                    const std::string& name, std::function<bool()> parse,
+                                    std::function<bool()> upload) {
+    {
+        std::lock_guard<std::mutex> lock(mUploadQueue.mutex);
+        ++mUploadQueue.pendingParses;
+    }
+
+    threadPool.submit([this, name, parse = std::move(parse),
+                       upload = std::move(upload)]() mutable {
+        Clock::time_point start = Clock::now();
+        bool parsed = false;
+        try {
+            parsed = parse();
+        } catch(const std::exception& e) {
+            // Would terminate the pool thread, and leave the parse pending forever
+            Log::error() << "Exception while parsing resource '" << name
+                         << "': " << e.what();
+        }
+        double parseTime = getMilliseconds(start);
+
+        if(parsed) {
+            queueUpload(name, std::move(upload), parseTime);
+        } else {
+            Log::error() << "Failed to parse resource '" << name << "'!";
+        }
+
+        std::lock_guard<std::mutex> lock(mUploadQueue.mutex);
+        mUploadQueue.parseFailed |= !parsed;
+        --mUploadQueue.pendingParses;
+        mUploadQueue.uploadAvailable.notify_one();
+    });
+}
+
+// Upload is wrapped to log the per-asset timings
+void ResourceSys::queueUpload(const std::string& name, std::function<bool()> upload,
+                              double parseTime) {
+    std::lock_guard<std::mutex> lock(mUploadQueue.mutex);
+    mUploadQueue.uploads.push([name, upload = std::move(upload), parseTime] {
+        Clock::time_point start = Clock::now();
+        bool uploaded = upload();
+        logLoadTimes(name, parseTime, getMilliseconds(start));
+        return uploaded;
+    });
+    mUploadQueue.uploadAvailable.notify_one();
+}
+
+// Runs uploads on the calling thread until every parse is done and uploaded
+bool ResourceSys::runUploads() {
+    bool success = true;
+
+    std::unique_lock<std::mutex> lock(mUploadQueue.mutex);
+    while(true) {
+        mUploadQueue.uploadAvailable.wait(lock, [this] {
+            return !mUploadQueue.uploads.empty() || mUploadQueue.pendingParses == 0;
+        });
+        if(mUploadQueue.uploads.empty()) break; // All parsed and uploaded
+
+        std::function<bool()> upload = std::move(mUploadQueue.uploads.front());
+        mUploadQueue.uploads.pop();
+
+        lock.unlock();
+        success &= upload();
+        lock.lock();
+    }
+
+    success &= !mUploadQueue.parseFailed;
+    mUploadQueue.parseFailed = false;
+    return success;
+}
+
+// Evicts the least recently used resources which are not used outside of the cache,
+// until both memory budgets are met
+void ResourceSys::enforceMemoryBudget() {
+    std::size_t cpuUsage = 0;
+    std::size_t gpuUsage = 0;
+    addMemoryUsage(mObjResources.entries, cpuUsage, gpuUsage);
+    addMemoryUsage(mAudioResources.entries, cpuUsage, gpuUsage);
+
+    while(cpuUsage > Constants::RESOURCE_CPU_MEMORY_BUDGET ||
+          gpuUsage > Constants::RESOURCE_GPU_MEMORY_BUDGET) {
+        Entry<ObjResource>* obj = findEvictable(mObjResources.entries);
+        Entry<AudioResource>* audio = findEvictable(mAudioResources.entries);
+
+        if(!obj && !audio) {
+            Log::warn() << "Resources in use exceed the memory budget (CPU: "
+                        << cpuUsage / (1024 * 1024) << " MiB, GPU: "
+                        << gpuUsage / (1024 * 1024) << " MiB)!";
+            break;
+        }
+
+        if(obj && (!audio || obj->lastUse < audio->lastUse)) {
+            evict(*obj, cpuUsage, gpuUsage);
+        } else {
+            evict(*audio, cpuUsage, gpuUsage);
+        }
+    }
+}
@@ -1,32 +1,124 @@
 #pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <mutex>
+#include <queue>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "AssetPack.hpp"
 #include "Obj/ObjResource.hpp"
 #include "ShaderResource.hpp"
 #include "AudioResource.hpp"
+#include "Utils/ThreadPool.hpp"
 
 class ResourceSys {
 public:
     static ResourceSys& get();
     ResourceSys() = default;
 
-    bool loadResources();
+    bool scanResources();
+    bool preloadResources(const std::vector<std::string>& names);
+
+    // Invalid handle if there is no such resource
+    ObjResource::Handle findObjResource(const std::string& name) const;
+    ShaderResource::Handle findShaderResource(const std::string& name) const;
+    AudioResource::Handle findAudioResource(const std::string& name) const;
+
+    // Loads the resource if needed. nullptr if the handle is invalid or loading fails.
+    ObjResource::Ptr getObjResource(ObjResource::Handle handle);
+    ShaderResource::CPtr getShaderResource(ShaderResource::Handle handle);
+    AudioResource::Ptr getAudioResource(AudioResource::Handle handle);
+
+    // Throw if there is no such resource or it fails to load
     ObjResource::Ptr getObjResource(const std::string& name);
-    ShaderResource::CPtr getShaderResource(const std::string& name) const;
+    ShaderResource::CPtr getShaderResource(const std::string& name);
     AudioResource::Ptr getAudioResource(const std::string& name);
 
 private:
-    std::unordered_map<std::string, ObjResource::Ptr> mObjResources;
-    std::unordered_map<std::string, ShaderResource::Ptr> mShaderResources;
-    std::unordered_map<std::string, AudioResource::Ptr> mAudioResources;
+    // A scanned resource, loaded on first use
+    template <typename Resource>
+    struct Entry {
+        std::string name;
+        std::vector<std::filesystem::path> paths;
+        std::uint32_t generation = 0;
+        typename Resource::Ptr resource; // nullptr if not loaded
+        std::size_t cpuMemoryUsage = 0;
+        std::size_t gpuMemoryUsage = 0;
+        std::uint64_t lastUse = 0;
+    };
+
+    // Entries of one resource type, indexed by handles
+    template <typename Resource>
+    struct Table {
+        std::vector<Entry<Resource>> entries;
+        std::unordered_map<std::string, std::uint32_t> indices; // By name
+
+        bool contains(const std::string& name) const {
+            return indices.find(name) != indices.end();
+        }
+        void add(const std::string& name, std::vector<std::filesystem::path> paths,
+                 std::uint32_t generation) {
+            indices[name] = static_cast<std::uint32_t>(entries.size());
+            entries.push_back({name, std::move(paths), generation, nullptr, 0, 0, 0});
+        }
+        ResourceHandle<Resource> find(const std::string& name) const {
+            auto it = indices.find(name);
+            if(it == indices.end()) return {};
+            return {it->second, entries[it->second].generation};
+        }
+        // nullptr if the handle is invalid or from a previous scan
+        Entry<Resource>* get(ResourceHandle<Resource> handle) {
+            if(handle.getIndex() >= entries.size()) return nullptr;
+            Entry<Resource>& entry = entries[handle.getIndex()];
+            return entry.generation == handle.getGeneration() ? &entry : nullptr;
+        }
+    };
+
+    // Parse can run on any thread, upload only on the main thread
+    struct LoadJob {
+        std::function<bool()> parse; // Optional
+        std::function<bool()> upload;
+    };
+
+    // GL side of loading, run on the main thread as parsed resources come in from
+    // the worker threads
+    struct UploadQueue {
+        std::mutex mutex;
+        std::condition_variable uploadAvailable;
+        std::queue<std::function<bool()>> uploads;
+        std::size_t pendingParses = 0;
+        bool parseFailed = false;
+    };
+
+    Table<ObjResource> mObjResources;
+    Table<ShaderResource> mShaderResources;
+    Table<AudioResource> mAudioResources;
+    std::uint32_t mScanGeneration = 0;
+    std::uint64_t mUseCounter = 0; // For LRU eviction
+    AssetPack::CPtr mAssetPack;    // Optional, replaces the resource dir
+    UploadQueue mUploadQueue;
 
     ResourceSys(const ResourceSys&) = delete;
     ResourceSys& operator=(const ResourceSys&) = delete;
     ResourceSys(ResourceSys&&) = delete;
     ResourceSys& operator=(ResourceSys&&) = delete;
 
-    bool loadResourcesFromDir(const std::filesystem::path& dirPath);
-    bool loadResource(const std::filesystem::path& path);
+    bool scanResourcesInDir(const std::filesystem::path& dirPath);
+    bool scanResource(const std::filesystem::path& path);
+    bool resourceFileExists(const std::filesystem::path& path) const;
+    LoadJob createObjLoadJob(std::uint32_t index);
+    LoadJob createShaderLoadJob(std::uint32_t index);
+    LoadJob createAudioLoadJob(std::uint32_t index);
+    bool load(const std::string& name, LoadJob job);
+    void parseInBackground(Utils::ThreadPool& threadPool, const std::string& name,
+                           std::function<bool()> parse, std::function<bool()> upload);
+    void queueUpload(const std::string& name, std::function<bool()> upload,
+                     double parseTime = 0.0);
+    bool runUploads();
+    void enforceMemoryBudget();
 };
@@ -2,19 +2,29 @@
 
 #include <utility>
 
+#include "AssetPack.hpp"
 #include "Log.hpp"
 #include "Utils/FileUtils.hpp"
 
+namespace {
+std::string readSource(const std::filesystem::path& path, const AssetPack* pack) {
+    if(!pack) return Utils::getFileContents(path);
+    return std::string(ResourceFile(path, pack).getText());
+}
+} // namespace
+
 ShaderResource::ShaderResource(const std::string& name,
                                const std::filesystem::path& vertexPath,
-                               const std::filesystem::path& fragmentPath)
+                               const std::filesystem::path& fragmentPath,
+                               const AssetPack* pack)
     : mName(name) {
     mUniformLocations.fill(-1);
     mUniformBlockLocations.fill(-1);
+    mStorageBlockLocations.fill(-1);
 
     // Get source
-    std::string vertexSource = Utils::getFileContents(vertexPath);
-    std::string fragmentSource = Utils::getFileContents(fragmentPath);
+    std::string vertexSource = readSource(vertexPath, pack);
+    std::string fragmentSource = readSource(fragmentPath, pack);
 
     // Compile
     GLuint vertexShader = compileShader(vertexPath, vertexSource, GL_VERTEX_SHADER);
@@ -23,12 +33,30 @@ ShaderResource::ShaderResource(const std::string& name,
 
     // Link
     if(vertexShader != 0 && fragmentShader != 0) {
-        mId = linkShaderProgram(mName, vertexShader, fragmentShader);
+        mId = linkShaderProgram(mName, {vertexShader, fragmentShader});
     }
 
     registerUniforms(); // For easier access later
 }
 
+// Compute shader program
+ShaderResource::ShaderResource(const std::string& name,
+                               const std::filesystem::path& computePath,
+                               const AssetPack* pack)
+    : mName(name) {
+    mUniformLocations.fill(-1);
+    mUniformBlockLocations.fill(-1);
+    mStorageBlockLocations.fill(-1);
+
+    std::string computeSource = readSource(computePath, pack);
+    GLuint computeShader = compileShader(computePath, computeSource, GL_COMPUTE_SHADER);
+    if(computeShader != 0) {
+        mId = linkShaderProgram(mName, {computeShader});
+    }
+
+    registerUniforms();
+}
+
 ShaderResource::~ShaderResource() { glDeleteProgram(mId); }
 
 ShaderResource::ShaderResource(ShaderResource&& other) noexcept { swap(*this, other); }
@@ -43,6 +71,7 @@ void swap(ShaderResource& first, ShaderResource& second) noexcept {
     std::swap(first.mId, second.mId);
     std::swap(first.mUniformLocations, second.mUniformLocations);
     std::swap(first.mUniformBlockLocations, second.mUniformBlockLocations);
+    std::swap(first.mStorageBlockLocations, second.mStorageBlockLocations);
 }
 
 // If uniform is not found, returns -1 (ignored uniform location by OpenGL)
@@ -64,6 +93,16 @@ GLint ShaderResource::getUniformBlock(std::size_t uniformBlockNameIndex) const {
     return mUniformBlockLocations[uniformBlockNameIndex];
 }
 
+// If storage block is not found, returns -1
+GLint ShaderResource::getStorageBlock(std::size_t storageBlockNameIndex) const {
+    if(storageBlockNameIndex >= mStorageBlockLocations.size()) {
+        Log::error() << "Storage block name index " << storageBlockNameIndex
+                     << " out of bounds.";
+        return -1;
+    }
+    return mStorageBlockLocations[storageBlockNameIndex];
+}
+
 // Static
 GLuint ShaderResource::compileShader(const std::filesystem::path& shaderPath,
                                      const std::string& shaderSource, GLenum type) {
@@ -105,17 +144,19 @@ GLuint ShaderResource::compileShader(const std::filesystem::path& shaderPath,
 
 // Static
 GLuint ShaderResource::linkShaderProgram(const std::string& shaderProgramName,
-                                         GLuint vertexShader, GLuint fragmentShader) {
+                                         const std::vector<GLuint>& shaders) {
     GLint programValid;
     GLuint program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
+    for(GLuint shader : shaders) {
+        glAttachShader(program, shader);
+    }
     glLinkProgram(program);
     glGetProgramiv(program, GL_LINK_STATUS, &programValid);
 
     // Flag shaders for deletion
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    for(GLuint shader : shaders) {
+        glDeleteShader(shader);
+    }
 
     if(!programValid) {
         std::string shaderLog =
@@ -187,6 +228,22 @@ void ShaderResource::registerUniforms() {
         registerUniformBlock(uniformNameBuffer, bindingPointCounter);
         bindingPointCounter++;
     }
+
+    // Shader storage blocks, with their own binding points
+    bindingPointCounter = 0;
+    glGetProgramInterfaceiv(mId, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &count);
+    for(int i = 0; i < count; i++) {
+        GLsizei charCount = 0;
+        glGetProgramResourceName(mId, GL_SHADER_STORAGE_BLOCK, i, bufferSize, &charCount,
+                                 uniformNameBuffer);
+        glShaderStorageBlockBinding(mId, i, bindingPointCounter);
+
+        Log::debug() << "Storage block '" << uniformNameBuffer
+                     << "' bound to binding point " << bindingPointCounter;
+
+        registerStorageBlock(uniformNameBuffer, bindingPointCounter);
+        bindingPointCounter++;
+    }
 }
 
 void ShaderResource::registerUniform(const std::string& uniformName) {
@@ -229,4 +286,23 @@ void ShaderResource::registerUniformBlock(const std::string& uniformBlockName,
     }
 
     Log::debug() << "Skipping unknown uniform block name '" << uniformBlockName << "'.";
-}
\ No newline at end of file
+}
+
+void ShaderResource::registerStorageBlock(const std::string& storageBlockName,
+                                          GLuint bindingPoint) {
+    auto storageBlockNameIndex = Constants::StorageBlockName::runtimeGet(storageBlockName);
+    if(storageBlockNameIndex.has_value()) {
+        if(mStorageBlockLocations[storageBlockNameIndex.value()] != -1) {
+            Log::warn() << "Storage block '" << storageBlockName
+                        << "' already registered for shader '" << mName << "'.";
+            return;
+        }
+        Log::debug() << "Registering storage block '" << storageBlockName
+                     << "' in shader'" << mName << "' at binding point " << bindingPoint
+                     << ".";
+        mStorageBlockLocations[storageBlockNameIndex.value()] = bindingPoint;
+        return;
+    }
+
+    Log::debug() << "Skipping unknown storage block name '" << storageBlockName << "'.";
+}
@@ -5,21 +5,34 @@
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "Constants.hpp"
+#include "ResourceHandle.hpp"
 
+class AssetPack;
 class ShaderResource {
 public:
     using Ptr = std::shared_ptr<ShaderResource>;
     using CPtr = std::shared_ptr<const ShaderResource>;
+    using Handle = ResourceHandle<ShaderResource>;
 
+    // Sources are read from the pack if given
     static Ptr create(const std::string& name, const std::filesystem::path& vertexPath,
-                      const std::filesystem::path& fragmentPath) {
-        return std::make_shared<ShaderResource>(name, vertexPath, fragmentPath);
+                      const std::filesystem::path& fragmentPath,
+                      const AssetPack* pack = nullptr) {
+        return std::make_shared<ShaderResource>(name, vertexPath, fragmentPath, pack);
+    }
+    static Ptr create(const std::string& name, const std::filesystem::path& computePath,
+                      const AssetPack* pack = nullptr) {
+        return std::make_shared<ShaderResource>(name, computePath, pack);
     }
 
     ShaderResource(const std::string& name, const std::filesystem::path& vertexPath,
-                   const std::filesystem::path& fragmentPath);
+                   const std::filesystem::path& fragmentPath,
+                   const AssetPack* pack = nullptr);
+    ShaderResource(const std::string& name, const std::filesystem::path& computePath,
+                   const AssetPack* pack = nullptr);
     ~ShaderResource();
     ShaderResource(const ShaderResource& other) = delete; // Don't copy shaders lol
     ShaderResource(ShaderResource&& other) noexcept;
@@ -31,21 +44,24 @@ public:
     const std::string& getName() const { return mName; }
     GLint getUniform(std::size_t uniformNameIndex) const;
     GLint getUniformBlock(std::size_t uniformBlockNameIndex) const;
+    GLint getStorageBlock(std::size_t storageBlockNameIndex) const;
 
 private:
     std::string mName; // Useful for logs
     GLuint mId = 0;
     std::array<GLint, Constants::UniformName::size()> mUniformLocations;
     std::array<GLint, Constants::UniformBlockName::size()> mUniformBlockLocations;
+    std::array<GLint, Constants::StorageBlockName::size()> mStorageBlockLocations;
 
     static GLuint compileShader(const std::filesystem::path& shaderPath,
                                 const std::string& shaderSource, GLenum type);
     static GLuint linkShaderProgram(const std::string& shaderProgramName,
-                                    GLuint vertexShader, GLuint fragmentShader);
+                                    const std::vector<GLuint>& shaders);
     static std::string getGLShaderDebugLog(GLuint object, PFNGLGETSHADERIVPROC glGet_iv,
                                            PFNGLGETSHADERINFOLOGPROC glGet__InfoLog);
 
     void registerUniforms();
     void registerUniform(const std::string& uniformName);
     void registerUniformBlock(const std::string& uniformBlockName, GLuint bindingPoint);
+    void registerStorageBlock(const std::string& storageBlockName, GLuint bindingPoint);
 };
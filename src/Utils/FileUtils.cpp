@@ -2,6 +2,7 @@
 
 #include <fstream>
 #include <sstream>
+#include <thread>
 
 #include "Log.hpp"
 
@@ -25,4 +26,37 @@ std::string getFileContents(const std::filesystem::path& path) {
 
     return "";
 }
+
+bool writeFileAtomically(const std::filesystem::path& path,
+                         const std::function<void(std::ofstream&)>& write) {
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    std::filesystem::path tempPath = path;
+    std::size_t threadHash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    tempPath += "." + std::to_string(threadHash) + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if(!file.is_open()) {
+            Log::warn() << "Cannot write '" << tempPath.string() << "'.";
+            return false;
+        }
+
+        write(file);
+        if(!file) {
+            Log::warn() << "Failed to write '" << tempPath.string() << "'.";
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+    if(error) {
+        Log::warn() << "Cannot write '" << path.string() << "': " << error.message();
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
 }  // namespace Utils
\ No newline at end of file
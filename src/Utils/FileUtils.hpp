@@ -1,8 +1,16 @@
 #pragma once
 
 #include <filesystem>
+#include <fstream>
+#include <functional>
 #include <string>
 
 namespace Utils {
 std::string getFileContents(const std::filesystem::path& path);
+
+// Writes to a temporary file renamed over path once complete, so readers never see
+// it half written, even with several threads writing the same path. Creates the
+// parent directories.
+bool writeFileAtomically(const std::filesystem::path& path,
+                         const std::function<void(std::ofstream&)>& write);
 }
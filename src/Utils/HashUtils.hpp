@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Utils {
+constexpr std::uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+constexpr std::uint64_t FNV_PRIME = 0x100000001b3ull;
+
+// FNV-1a, chain calls by passing the previous hash
+constexpr std::uint64_t hashBytes(const unsigned char* data, std::size_t size,
+                                  std::uint64_t hash = FNV_OFFSET_BASIS) {
+    for(std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+constexpr std::uint64_t hashString(std::string_view string,
+                                   std::uint64_t hash = FNV_OFFSET_BASIS) {
+    for(char c : string) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * FNV_PRIME;
+    }
+    return hash;
+}
+} // namespace Utils
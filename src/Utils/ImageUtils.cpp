@@ -0,0 +1,36 @@
+#include "ImageUtils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace Utils {
+std::vector<unsigned char> halveImage(const std::vector<unsigned char>& pixels,
+                                      int& width, int& height, int components) {
+    int halfWidth = std::max(width / 2, 1);
+    int halfHeight = std::max(height / 2, 1);
+    std::vector<unsigned char> result(static_cast<std::size_t>(halfWidth) * halfHeight *
+                                      components);
+
+    auto texel = [&](int x, int y, int c) {
+        x = std::min(x, width - 1);
+        y = std::min(y, height - 1);
+        return static_cast<unsigned>(
+            pixels[(static_cast<std::size_t>(y) * width + x) * components + c]);
+    };
+    for(int y = 0; y < halfHeight; ++y) {
+        for(int x = 0; x < halfWidth; ++x) {
+            for(int c = 0; c < components; ++c) {
+                unsigned sum = texel(2 * x, 2 * y, c) + texel(2 * x + 1, 2 * y, c) +
+                               texel(2 * x, 2 * y + 1, c) +
+                               texel(2 * x + 1, 2 * y + 1, c);
+                result[(static_cast<std::size_t>(y) * halfWidth + x) * components + c] =
+                    static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+
+    width = halfWidth;
+    height = halfHeight;
+    return result;
+}
+} // namespace Utils
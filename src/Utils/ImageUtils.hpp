@@ -0,0 +1,10 @@
+#pragma once
+
+#include <vector>
+
+namespace Utils {
+// Next mip level of tightly packed 8 bit pixels with a 2x2 box filter. Odd sizes are
+// rounded down like GL mip levels, width and height are updated.
+std::vector<unsigned char> halveImage(const std::vector<unsigned char>& pixels,
+                                      int& width, int& height, int components);
+} // namespace Utils
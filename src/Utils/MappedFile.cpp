@@ -0,0 +1,78 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Log.hpp"
+
+namespace Utils {
+#ifdef _WIN32
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+        Log::debug() << "Cannot open '" << path.string() << "' for mapping.";
+        return;
+    }
+    mFileHandle = file;
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!mapping) {
+        Log::error() << "Failed to map '" << path.string() << "'.";
+        return;
+    }
+    mMappingHandle = mapping;
+
+    mData = static_cast<const unsigned char*>(
+        MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if(mData) {
+        mSize = static_cast<std::size_t>(size.QuadPart);
+    } else {
+        Log::error() << "Failed to map '" << path.string() << "'.";
+    }
+}
+
+MappedFile::~MappedFile() {
+    if(mData) UnmapViewOfFile(mData);
+    if(mMappingHandle) CloseHandle(mMappingHandle);
+    if(mFileHandle) CloseHandle(mFileHandle);
+}
+#else
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    int file = open(path.c_str(), O_RDONLY);
+    if(file < 0) {
+        Log::debug() << "Cannot open '" << path.string() << "' for mapping.";
+        return;
+    }
+
+    // The mapping stays valid once the descriptor is closed
+    struct stat status;
+    if(fstat(file, &status) == 0 && status.st_size > 0) {
+        void* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ,
+                          MAP_PRIVATE, file, 0);
+        if(data != MAP_FAILED) {
+            mData = static_cast<const unsigned char*>(data);
+            mSize = static_cast<std::size_t>(status.st_size);
+        } else {
+            Log::error() << "Failed to map '" << path.string() << "'.";
+        }
+    }
+    close(file);
+}
+
+MappedFile::~MappedFile() {
+    if(mData) munmap(const_cast<unsigned char*>(mData), mSize);
+}
+#endif
+} // namespace Utils
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace Utils {
+// Read-only memory mapping of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+    MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False if the file could not be opened, or is empty
+    bool isOpen() const { return mData != nullptr; }
+    const unsigned char* getData() const { return mData; }
+    std::size_t getSize() const { return mSize; }
+
+private:
+    const unsigned char* mData = nullptr;
+    std::size_t mSize = 0;
+#ifdef _WIN32
+    void* mFileHandle = nullptr;
+    void* mMappingHandle = nullptr;
+#endif
+};
+} // namespace Utils
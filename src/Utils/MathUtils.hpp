@@ -56,5 +56,23 @@ inline std::vector<std::vector<glm::vec3>> generateSphere(float radius, const gl
     return sphereCircles;
 }
 
+// Planes are extracted from the view-projection matrix, a sphere is culled only if
+// it is completely behind one of them
+inline bool isSphereInFrustum(const glm::mat4& viewProjection, const glm::vec3& center,
+                              float radius) {
+    glm::vec4 rows[4];
+    for(int i = 0; i < 4; ++i) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i],
+                            viewProjection[2][i], viewProjection[3][i]);
+    }
 
+    for(int i = 0; i < 6; ++i) {
+        glm::vec4 plane = i % 2 == 0 ? rows[3] + rows[i / 2] : rows[3] - rows[i / 2];
+        float length = glm::length(glm::vec3(plane));
+        if(glm::dot(glm::vec3(plane), center) + plane.w < -radius * length) {
+            return false;
+        }
+    }
+    return true;
+}
 } // namespace Utils
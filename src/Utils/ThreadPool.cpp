@@ -0,0 +1,71 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace Utils {
+namespace {
+thread_local bool isPoolThread = false;
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threadCount) {
+    if(threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    mThreads.reserve(threadCount);
+    for(std::size_t i = 0; i < threadCount; ++i) {
+        mThreads.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mJobAvailable.notify_all();
+
+    for(std::thread& thread : mThreads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobs.push(std::move(job));
+        ++mUnfinishedJobs;
+    }
+    mJobAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mJobsFinished.wait(lock, [this] { return mUnfinishedJobs == 0; });
+}
+
+bool ThreadPool::isWorkerThread() { return isPoolThread; }
+
+void ThreadPool::work() {
+    isPoolThread = true;
+    while(true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mJobAvailable.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+            if(mJobs.empty()) return; // Stopping
+
+            job = std::move(mJobs.front());
+            mJobs.pop();
+        }
+
+        job();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(--mUnfinishedJobs == 0) {
+            mJobsFinished.notify_all();
+        }
+    }
+}
+} // namespace Utils
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Utils {
+// Fixed set of worker threads running jobs in submission order.
+class ThreadPool {
+public:
+    // 0 uses one thread per hardware thread
+    explicit ThreadPool(std::size_t threadCount = 0);
+    ~ThreadPool(); // Finishes queued jobs first
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+    void wait(); // Until every submitted job is done
+    std::size_t getThreadCount() const { return mThreads.size(); }
+    // True on the threads of any pool, where jobs shouldn't start a pool of their own
+    static bool isWorkerThread();
+
+private:
+    std::vector<std::thread> mThreads;
+    std::queue<std::function<void()>> mJobs;
+    std::size_t mUnfinishedJobs = 0;
+    bool mStopping = false;
+    std::mutex mMutex;
+    std::condition_variable mJobAvailable;
+    std::condition_variable mJobsFinished;
+
+    void work();
+};
+} // namespace Utils
@@ -1,15 +1,25 @@
 #include <iostream>
 #include <string>
 
+#include "Benchmarks.hpp"
+#include "Constants.hpp"
 #include "Game.hpp"
 #include "Log.hpp"
+#include "Systems/ResourceSys/AssetPack.hpp"
+#include "Systems/ResourceSys/Obj/GltfLoader.hpp"
 #include "Utils/getopt.h"
 
 void printHelp(const std::string& progName) {
     std::cout << "Usage:\n"
               << "    " << progName << '\n'
               << "Options:\n"
-              << "    -l        logging level (0: errors only, 3: all)" << std::endl;
+              << "    -l        logging level (0: errors only, 3: all)\n"
+              << "    -b        run a benchmark and exit (" << Benchmarks::getNames() << ")\n"
+              << "    -p <file> pack the resource directory into an asset pack and exit\n"
+              << "              (loaded instead of the directory if named "
+              << Constants::RESOURCE_PACK_PATH << ")\n"
+              << "    -t        bake compressed textures of the glTF models and exit\n"
+              << "              (into " << Constants::MESH_CACHE_DIR << ")" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
@@ -19,8 +29,12 @@ int main(int argc, char* argv[]) {
     LogLevel loggingLevel = LogLevel::INFO;
 #endif
 
+    std::string benchmarkName;
+    std::string packPath;
+    bool bakeTextures = false;
+
     int c;
-    while((c = getopt(argc, argv, "hl:")) != -1) {
+    while((c = getopt(argc, argv, "hl:b:p:t")) != -1) {
         switch(c) {
             case '?':
             case 'l': {
@@ -31,6 +45,15 @@ int main(int argc, char* argv[]) {
                 }
                 break;
             }
+            case 'b':
+                benchmarkName = optarg;
+                break;
+            case 'p':
+                packPath = optarg;
+                break;
+            case 't':
+                bakeTextures = true;
+                break;
             case 'h':
             default:
                 printHelp(argv[0]);
@@ -43,6 +66,16 @@ int main(int argc, char* argv[]) {
     }
 
     Log::setLevel(loggingLevel);
+    if(!benchmarkName.empty()) {
+        return Benchmarks::run(benchmarkName) ? 0 : 1;
+    }
+    if(!packPath.empty()) {
+        return AssetPack::build(Constants::RESOURCE_DIR, packPath) ? 0 : 1;
+    }
+    if(bakeTextures) {
+        return GltfLoader::bakeTextures(Constants::RESOURCE_DIR) ? 0 : 1;
+    }
+
     Game game;
     game.start();
 